@@ -0,0 +1,107 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <assert.h>
+
+#include "PropertyAccumulator.h"
+
+using namespace libucd;
+
+// Add the ascending ranges [first, last) to /set/. Within one pass over
+// a file they arrive in code point order and go on the end of the set,
+// but a later input file may revisit lower code points. Those are
+// gathered into a set of their own and merged in as a union, which
+// also handles ranges that overlap existing ones from below.
+template<class Iterator>
+static void
+addRanges(CodePointSet& set, Iterator first, Iterator last)
+{
+  if (first == last)
+    return;
+
+  if (set.empty() || set.rbegin()->min() <= first->min()) {
+    set.append_sorted(first, last);
+  }
+  else {
+    CodePointSet ranges(set.resource());
+    ranges.assign_sorted(first, last);
+    set.insert(ranges);
+  }
+
+#ifndef NDEBUG
+  for (Iterator it = first; it != last; ++it)
+    assert(it->empty() || set.contains(*it));
+#endif
+}
+
+void
+PropertyAccumulator::flush()
+{
+  if (!m_run.empty())
+    addRanges(m_values[m_runValue], &m_run, &m_run + 1);
+  m_run = CodePointRange();
+}
+
+void
+PropertyAccumulator::add(const CodePointRange& r, const char *value, size_t len)
+{
+  bool extends =
+    !m_run.empty() &&
+    (m_run.max() != CODEPOINT_EOF) && ((m_run.max() + 1) == r.min()) &&
+    (m_runValue.size() == len) && (m_runValue.compare(0, len, value, len) == 0);
+
+  if (extends) {
+    m_run = m_run | r;
+    return;
+  }
+
+  flush();
+  m_run = r;
+  m_runValue.assign(value, len);
+}
+
+void
+PropertyAccumulator::append(const ValueMap& values)
+{
+  flush();
+
+  for (auto v = values.begin(); v != values.end(); v++) {
+    // Ranges that meet at the shard boundary are joined.
+    addRanges(m_values[v->first], v->second.begin(), v->second.end());
+  }
+}
@@ -0,0 +1,89 @@
+#ifndef PROPERTYACCUMULATOR_H
+#define PROPERTYACCUMULATOR_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <map>
+#include <string>
+
+#include "CodePointSet.h"
+
+/// @brief Collects, for one property, the set of code points that have
+/// each of its values.
+///
+/// Records arrive in ascending code point order and neighbouring records
+/// usually share a value, so the accumulator keeps the current run of
+/// equal values and only touches the per-value CodePointSet when the run
+/// ends. Memory use is proportional to the number of output ranges, not
+/// to the number of input records.
+class PropertyAccumulator {
+  public:
+    typedef std::map<std::string, libucd::CodePointSet> ValueMap;
+
+  private:
+    ValueMap m_values;
+    std::string m_runValue;
+    libucd::CodePointRange m_run;
+
+    void flush();
+
+  public:
+    /// @brief Record that every code point in @p r has the value given by
+    /// the @p len characters at @p value.
+    void add(const libucd::CodePointRange& r, const char *value, size_t len);
+
+    /// @brief Flush the pending run. Must be called once all records have
+    /// been added, before values() is used.
+    void finish() { flush(); }
+
+    /// @brief Append the values collected by @p shard, which saw the
+    /// records that follow the ones seen by this accumulator. Where the
+    /// last range of a value here can merge with the first range of the
+    /// same value in @p shard, the two are joined into one.
+    void append(const PropertyAccumulator& shard) { append(shard.m_values); }
+
+    /// @brief Add the code points of each value in @p values, such as a
+    /// property digested from one input file and read back from the
+    /// cache.
+    void append(const ValueMap& values);
+
+    const ValueMap& values() const { return m_values; }
+};
+
+#endif // PROPERTYACCUMULATOR_H
@@ -0,0 +1,223 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <errno.h>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "MappedFile.h"
+#include "PropertyCache.h"
+#include "Sha256.h"
+
+using namespace libucd;
+
+// Bump whenever the digest of a file could change for the same input,
+// so that entries written by older versions are no longer found.
+static const char *const CACHE_VERSION = "compile-props cache 2";
+
+// The second line of every entry, naming the input it was made from.
+static std::string
+sourceLine(const PropertyCache::Hash& file)
+{
+  std::ostringstream os;
+  os << "source " << file.digest << ' ' << file.size;
+  return os.str();
+}
+
+// Key for an entry about /file/, qualified by the NUL-separated /parts/.
+static std::string
+entryKey(const PropertyCache::Hash& file, const std::vector<std::string>& parts)
+{
+  Sha256 h;
+  h.updateString(CACHE_VERSION);
+  h.updateString(sourceLine(file));
+  for (size_t i = 0; i < parts.size(); i++)
+    h.updateString(parts[i]);
+  return h.hexDigest();
+}
+
+// Read the header of an entry and check that it is of this version and
+// was made from /file/.
+static bool
+readHeader(std::istream& in, const PropertyCache::Hash& file)
+{
+  std::string version, source;
+  return std::getline(in, version) && version == CACHE_VERSION &&
+    std::getline(in, source) && source == sourceLine(file);
+}
+
+PropertyCache::PropertyCache(const std::string& dir)
+  : m_dir(dir)
+{
+  if (mkdir(dir.c_str(), 0777) < 0 && errno != EEXIST)
+    throw std::runtime_error(dir + ": " + strerror(errno));
+}
+
+PropertyCache::Hash
+PropertyCache::hashFile(const std::string& path)
+{
+  MappedFile file(path);
+  Sha256 h;
+  h.update(file.data(), file.size());
+
+  Hash hash;
+  hash.digest = h.hexDigest();
+  hash.size = file.size();
+  return hash;
+}
+
+std::string
+PropertyCache::entryPath(const char *kind, const std::string& key) const
+{
+  return m_dir + '/' + key + '.' + kind;
+}
+
+void
+PropertyCache::store(const std::string& path, const std::string& data) const
+{
+  std::ostringstream tmp;
+  tmp << path << ".tmp" << getpid();
+
+  std::ofstream os(tmp.str().c_str(), std::ios::binary);
+  os.write(data.data(), data.size());
+  os.close();
+  if (!os || rename(tmp.str().c_str(), path.c_str()) < 0) {
+    unlink(tmp.str().c_str());
+    throw std::runtime_error(path + ": cannot write cache entry");
+  }
+}
+
+bool
+PropertyCache::loadManifest(const Hash& file,
+                            const std::set<std::string>& selected,
+                            std::vector<std::string>& properties) const
+{
+  std::vector<std::string> parts(selected.begin(), selected.end());
+  std::ifstream in(entryPath("manifest", entryKey(file, parts)).c_str());
+  if (!readHeader(in, file))
+    return false;
+
+  std::string line;
+  properties.clear();
+  while (std::getline(in, line))
+    properties.push_back(line);
+  return !in.bad();
+}
+
+void
+PropertyCache::storeManifest(const Hash& file,
+                             const std::set<std::string>& selected,
+                             const std::vector<std::string>& properties) const
+{
+  std::vector<std::string> parts(selected.begin(), selected.end());
+  std::string data =
+    std::string(CACHE_VERSION) + "\n" + sourceLine(file) + "\n";
+  for (size_t i = 0; i < properties.size(); i++)
+    data += properties[i] + "\n";
+  store(entryPath("manifest", entryKey(file, parts)), data);
+}
+
+// A fragment is the version and source lines, the number of values,
+// and for each value its length-prefixed name, its number of ranges and
+// the ranges in hex. Whatever a corrupt fragment holds, loading it fails
+// rather than allocating without bound or producing unordered ranges.
+bool
+PropertyCache::loadFragment(const Hash& file, const std::string& property,
+                            PropertyAccumulator::ValueMap& values) const
+{
+  std::ifstream in(entryPath("fragment", entryKey(file, { property })).c_str(),
+                   std::ios::binary);
+  if (!in.seekg(0, std::ios::end))
+    return false;
+  std::streamoff fileSize = in.tellg();
+  in.seekg(0);
+  if (!readHeader(in, file))
+    return false;
+
+  values.clear();
+  size_t nValues = 0;
+  in >> nValues;
+  for (size_t v = 0; in && v < nValues; v++) {
+    size_t len = 0;
+    in >> len;
+    in.get();
+    if (!in || len > uint64_t(fileSize - in.tellg()))
+      return false;
+    std::string name(len, '\0');
+    in.read(&name[0], len);
+
+    std::vector<CodePointRange> ranges;
+    size_t nRanges = 0;
+    in >> nRanges;
+    for (size_t r = 0; in && r < nRanges; r++) {
+      CodePoint_t min, max;
+      in >> std::hex >> min >> max >> std::dec;
+      if (min > max || max > CODEPOINT_MAX ||
+          (!ranges.empty() && min <= ranges.back().max()))
+        return false;
+      ranges.push_back(CodePointRange(min, max));
+    }
+
+    values[name].assign_sorted(ranges.begin(), ranges.end());
+  }
+
+  return bool(in);
+}
+
+void
+PropertyCache::storeFragment(const Hash& file, const std::string& property,
+                             const PropertyAccumulator::ValueMap& values) const
+{
+  std::ostringstream os;
+  os << CACHE_VERSION << '\n' << sourceLine(file) << '\n'
+     << values.size() << '\n';
+  for (auto v = values.begin(); v != values.end(); v++) {
+    os << v->first.size() << ' ' << v->first << '\n'
+       << v->second.size() << '\n' << std::hex;
+    for (auto r = v->second.begin(); r != v->second.end(); r++)
+      os << r->min() << ' ' << r->max() << '\n';
+    os << std::dec;
+  }
+  store(entryPath("fragment", entryKey(file, { property })), os.str());
+}
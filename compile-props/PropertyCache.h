@@ -0,0 +1,106 @@
+#ifndef PROPERTYCACHE_H
+#define PROPERTYCACHE_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <set>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "PropertyAccumulator.h"
+
+/// @brief A content-addressed, on-disk cache of digested properties.
+///
+/// Each input file is identified by the SHA-256 digest and the size of
+/// its contents. For each
+/// file the cache holds a manifest, listing the properties the file
+/// defines, and one fragment per property, holding the code points of
+/// each of the property's values as digested from that file alone.
+/// Since the database is the union of the per-file digests, a property
+/// is only re-digested when one of the files that define it changes.
+/// Every entry also records the digest and size of the file it was made
+/// from, and is ignored unless both match.
+///
+/// Entries are never modified in place: a changed input has a new hash
+/// and therefore new entries. Each entry is written to a temporary file
+/// and renamed into place, so concurrent runs sharing a cache directory
+/// do not see partial entries. Stale entries are never removed; delete
+/// the directory to reclaim the space.
+class PropertyCache {
+  public:
+    /// @brief Identity of the contents of an input file.
+    struct Hash {
+      std::string digest;       // SHA-256, in hex
+      uint64_t size;            // in bytes
+    };
+
+  private:
+    std::string m_dir;
+
+    std::string entryPath(const char *kind, const std::string& key) const;
+    void store(const std::string& path, const std::string& data) const;
+
+  public:
+    /// @brief Use (and if necessary create) the cache directory @p dir.
+    /// Throws std::runtime_error if it cannot be created.
+    explicit PropertyCache(const std::string& dir);
+
+    /// @brief SHA-256 digest and size of the contents of @p path.
+    static Hash hashFile(const std::string& path);
+
+    /// @brief Read the manifest of the file whose hash is @p file, as
+    /// digested with property selection @p selected, into @p properties.
+    /// Returns false if there is none.
+    bool loadManifest(const Hash& file, const std::set<std::string>& selected,
+                      std::vector<std::string>& properties) const;
+    void storeManifest(const Hash& file,
+                       const std::set<std::string>& selected,
+                       const std::vector<std::string>& properties) const;
+
+    /// @brief Read the values of @p property digested from the file
+    /// whose hash is @p file into @p values. Returns false if there is
+    /// no such fragment or it cannot be read.
+    bool loadFragment(const Hash& file, const std::string& property,
+                      PropertyAccumulator::ValueMap& values) const;
+    void storeFragment(const Hash& file, const std::string& property,
+                       const PropertyAccumulator::ValueMap& values) const;
+};
+
+#endif // PROPERTYCACHE_H
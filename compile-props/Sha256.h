@@ -0,0 +1,71 @@
+#ifndef SHA256_H
+#define SHA256_H
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+/// @brief Incremental SHA-256 (FIPS 180-4), used to identify cache
+/// entries by their contents.
+class Sha256 {
+    uint32_t m_state[8];
+    unsigned char m_block[64];
+    size_t m_blockLen;          // bytes held in m_block
+    uint64_t m_length;          // bytes hashed so far
+
+    void compress(const unsigned char *block);
+
+  public:
+    Sha256();
+
+    /// @brief Hash the @p len bytes at @p data.
+    void update(const void *data, size_t len);
+
+    /// @brief Hash @p s, including its terminating NUL, so that the
+    /// boundaries of a sequence of strings are part of the digest.
+    void updateString(const std::string& s)
+    { update(s.c_str(), s.size() + 1); }
+
+    /// @brief Finish hashing and return the 32-byte digest as 64
+    /// lower-case hex digits. The object must not be used afterwards.
+    std::string hexDigest();
+};
+
+#endif // SHA256_H
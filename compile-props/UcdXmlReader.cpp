@@ -0,0 +1,410 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <ctype.h>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "MappedFile.h"
+#include "MemoryResource.h"
+#include "UcdXmlReader.h"
+
+using namespace libucd;
+
+// Properties whose values are strings or code point mappings that are
+// (nearly) unique to each code point. Collecting a set per value for
+// these would cost a range per code point, so they are skipped unless
+// asked for by name.
+static const char *const STRING_PROPERTIES[] = {
+  "na", "na1", "JSN", "isc", "dm", "bmg", "bpb", "suc", "slc", "stc",
+  "uc", "lc", "tc", "scf", "cf", "FC_NFKC", "NFKC_CF", "NFKC_SCF",
+  "EqUIdeo", "kCompatibilityVariant",
+};
+
+static bool
+parseHex(const XmlString& s, CodePoint_t& cp)
+{
+  if (s.size == 0 || s.size > 8)
+    return false;
+
+  cp = 0;
+  for (size_t i = 0; i < s.size; i++) {
+    char c = s.data[i];
+    cp <<= 4;
+    if (c >= '0' && c <= '9')
+      cp |= c - '0';
+    else if (c >= 'A' && c <= 'F')
+      cp |= c - 'A' + 10;
+    else if (c >= 'a' && c <= 'f')
+      cp |= c - 'a' + 10;
+    else
+      return false;
+  }
+  return true;
+}
+
+static bool
+isRecord(const XmlString& name)
+{
+  return (name == "char") || (name == "reserved") ||
+    (name == "noncharacter") || (name == "surrogate");
+}
+
+static bool
+isCodePointAttribute(const XmlString& name)
+{
+  return (name == "cp") || (name == "first-cp") || (name == "last-cp");
+}
+
+UcdXmlReader::UcdXmlReader(PropertyMap& properties,
+                           const std::set<std::string>& selected)
+  : m_properties(properties), m_selected(selected), m_inRepertoire(false)
+{
+}
+
+bool
+UcdXmlReader::wants(const std::string& property) const
+{
+  if (!m_selected.empty())
+    return m_selected.count(property) != 0;
+
+  // Unihan fields are all named kXxx.
+  if (property.size() > 1 && property[0] == 'k' && isupper((unsigned char) property[1]))
+    return false;
+
+  for (size_t i = 0; i < sizeof(STRING_PROPERTIES) / sizeof(STRING_PROPERTIES[0]); i++) {
+    if (property == STRING_PROPERTIES[i])
+      return false;
+  }
+  return true;
+}
+
+PropertyAccumulator *
+UcdXmlReader::accumulatorFor(const XmlString& name)
+{
+  std::string property = name.str();
+  if (!wants(property))
+    return 0;
+  return &m_properties[property];
+}
+
+PropertyAccumulator *
+UcdXmlReader::accumulatorFor(const XmlString& name, size_t slot)
+{
+  if (slot < m_slots.size()) {
+    const Slot& s = m_slots[slot];
+    if (s.name.size() == name.size &&
+        s.name.compare(0, name.size, name.data, name.size) == 0)
+      return s.accumulator;
+  }
+  else {
+    m_slots.resize(slot + 1);
+  }
+
+  Slot& s = m_slots[slot];
+  s.name = name.str();
+  s.accumulator = accumulatorFor(name);
+  return s.accumulator;
+}
+
+void
+UcdXmlReader::record(const std::vector<XmlAttribute>& attrs)
+{
+  CodePoint_t first = CODEPOINT_EOF;
+  CodePoint_t last = CODEPOINT_EOF;
+
+  for (size_t i = 0; i < attrs.size(); i++) {
+    const XmlAttribute& a = attrs[i];
+    bool ok = true;
+    if (a.name == "cp") {
+      ok = parseHex(a.value, first);
+      last = first;
+    }
+    else if (a.name == "first-cp")
+      ok = parseHex(a.value, first);
+    else if (a.name == "last-cp")
+      ok = parseHex(a.value, last);
+
+    if (!ok)
+      throw std::runtime_error(m_source + ": bad code point '" + a.value.str() + "'");
+  }
+
+  if (first == CODEPOINT_EOF || last == CODEPOINT_EOF || last < first ||
+      last > CODEPOINT_MAX)
+    throw std::runtime_error(m_source + ": record without a valid cp or first-cp/last-cp");
+
+  CodePointRange range(first, last);
+
+  m_recordAccumulators.clear();
+
+  for (size_t i = 0; i < attrs.size(); i++) {
+    const XmlAttribute& a = attrs[i];
+    if (isCodePointAttribute(a.name))
+      continue;
+
+    PropertyAccumulator *acc = accumulatorFor(a.name, i);
+    if (!acc)
+      continue;
+
+    m_recordAccumulators.push_back(acc);
+
+    if (memchr(a.value.data, '&', a.value.size)) {
+      m_decoded = XmlReader::decode(a.value);
+      acc->add(range, m_decoded.data(), m_decoded.size());
+    }
+    else {
+      acc->add(range, a.value.data, a.value.size);
+    }
+  }
+
+  // Group values apply to the properties the record did not give.
+  for (size_t i = 0; i < m_groupValues.size(); i++) {
+    PropertyAccumulator *acc = m_groupValues[i].first;
+    bool overridden = false;
+    for (size_t j = 0; j < m_recordAccumulators.size() && !overridden; j++)
+      overridden = (m_recordAccumulators[j] == acc);
+    if (!overridden)
+      acc->add(range, m_groupValues[i].second.data(), m_groupValues[i].second.size());
+  }
+}
+
+void
+UcdXmlReader::startElement(const XmlString& name,
+                           const std::vector<XmlAttribute>& attrs)
+{
+  if (name == "repertoire") {
+    m_inRepertoire = true;
+    return;
+  }
+
+  if (!m_inRepertoire)
+    return;
+
+  if (name == "group") {
+    m_groupValues.clear();
+    for (size_t i = 0; i < attrs.size(); i++) {
+      PropertyAccumulator *acc = accumulatorFor(attrs[i].name);
+      if (acc)
+        m_groupValues.push_back({ acc, XmlReader::decode(attrs[i].value) });
+    }
+  }
+  else if (isRecord(name)) {
+    record(attrs);
+  }
+}
+
+void
+UcdXmlReader::endElement(const XmlString& name)
+{
+  if (name == "repertoire")
+    m_inRepertoire = false;
+  else if (name == "group")
+    m_groupValues.clear();
+}
+
+void
+UcdXmlReader::read(const std::string& path)
+{
+  MappedFile file(path);
+  XmlReader reader(file.begin(), file.end(), path);
+
+  m_source = path;
+  m_inRepertoire = false;
+  m_groupValues.clear();
+  m_slots.clear();
+
+  reader.parse(*this);
+}
+
+void
+UcdXmlReader::finish()
+{
+  for (auto it = m_properties.begin(); it != m_properties.end(); it++)
+    it->second.finish();
+}
+
+void
+UcdXmlReader::readShard(const std::string& source,
+                        const char *begin, const char *end,
+                        const char *groupTag, const char *groupTagEnd)
+{
+  m_source = source;
+  m_inRepertoire = true;
+  m_groupValues.clear();
+  m_slots.clear();
+
+  // A shard that starts inside a <group> sees its start tag first, so
+  // that the group's values apply to the shard's records.
+  if (groupTag)
+    XmlReader(groupTag, groupTagEnd, source).parse(*this);
+
+  XmlReader(begin, end, source).parse(*this);
+}
+
+// Find the first occurrence of /s/ in [p, end), or return /end/.
+static const char *
+findString(const char *p, const char *end, const char *s)
+{
+  size_t n = strlen(s);
+  while ((end - p) >= (ptrdiff_t) n) {
+    p = static_cast<const char *>(memchr(p, s[0], end - p - n + 1));
+    if (!p)
+      return end;
+    if (memcmp(p, s, n) == 0)
+      return p;
+    p++;
+  }
+  return end;
+}
+
+// Is there a tag at /p/ at which a shard may begin?
+static bool
+isShardStart(const char *p, const char *end)
+{
+  static const char *const TAGS[] = {
+    "<char", "<reserved", "<noncharacter", "<surrogate", "<group", "</group",
+  };
+
+  for (size_t i = 0; i < sizeof(TAGS) / sizeof(TAGS[0]); i++) {
+    size_t n = strlen(TAGS[i]);
+    if ((end - p) > (ptrdiff_t) n && memcmp(p, TAGS[i], n) == 0 &&
+        (p[n] == ' ' || p[n] == '>' || p[n] == '/' || p[n] == '\n'))
+      return true;
+  }
+  return false;
+}
+
+void
+UcdXmlReader::readSharded(const std::string& path,
+                          const std::set<std::string>& selected,
+                          unsigned nShards, PropertyMap& properties)
+{
+  MappedFile file(path);
+
+  const char *rep = findString(file.begin(), file.end(), "<repertoire");
+  const char *body = (rep == file.end()) ? rep : findString(rep, file.end(), ">");
+  const char *bodyEnd = (body == file.end()) ? body : findString(body, file.end(), "</repertoire>");
+
+  if (nShards < 2 || bodyEnd == file.end()) {
+    UcdXmlReader reader(properties, selected);
+    reader.read(path);
+    return;
+  }
+  body++;
+
+  // The UCD has no comments or CDATA within the repertoire, so every
+  // '<' there begins a tag. Move each split point forward to the next
+  // record or group tag.
+  std::vector<const char *> splits;
+  splits.push_back(body);
+  for (unsigned k = 1; k < nShards; k++) {
+    const char *p = body + (size_t) (bodyEnd - body) * k / nShards;
+    if (p < splits.back())
+      p = splits.back();
+    for (;;) {
+      p = static_cast<const char *>(memchr(p, '<', bodyEnd - p));
+      if (!p || isShardStart(p, bodyEnd))
+        break;
+      p++;
+    }
+    if (p && p != splits.back())
+      splits.push_back(p);
+  }
+  splits.push_back(bodyEnd);
+
+  // Locate the <group> start tags and their end tags, so that each shard
+  // can be told which group (if any) it starts inside.
+  std::vector<std::pair<const char *, const char *> > groups;
+  for (const char *p = body; (p = findString(p, bodyEnd, "<group")) != bodyEnd; ) {
+    const char *gt = findString(p, bodyEnd, ">");
+    const char *close = findString(gt, bodyEnd, "</group");
+    groups.push_back({ p, close });
+    p = gt;
+  }
+
+  size_t n = splits.size() - 1;
+
+  // The shard results are only read back once, to be appended to
+  // /properties/, so each shard builds its sets in an arena of its own
+  // and frees them in one go. The arenas are declared first so that
+  // they outlive the results.
+  std::vector<std::unique_ptr<MonotonicArena> > arenas;
+  for (size_t k = 0; k < n; k++)
+    arenas.emplace_back(new MonotonicArena());
+
+  std::vector<PropertyMap> results(n);
+  std::vector<std::exception_ptr> errors(n);
+  std::vector<std::thread> threads;
+
+  for (size_t k = 0; k < n; k++) {
+    const char *groupTag = 0;
+    const char *groupTagEnd = 0;
+    for (size_t g = 0; g < groups.size() && groups[g].first < splits[k]; g++) {
+      if (groups[g].second >= splits[k]) {
+        groupTag = groups[g].first;
+        groupTagEnd = findString(groupTag, bodyEnd, ">") + 1;
+      }
+    }
+
+    threads.push_back(std::thread([&, k, groupTag, groupTagEnd]() {
+      try {
+        DefaultResourceScope scope(arenas[k].get());
+        UcdXmlReader reader(results[k], selected);
+        reader.readShard(path, splits[k], splits[k + 1], groupTag, groupTagEnd);
+        reader.finish();
+      }
+      catch (...) {
+        errors[k] = std::current_exception();
+      }
+    }));
+  }
+
+  for (size_t k = 0; k < n; k++)
+    threads[k].join();
+  for (size_t k = 0; k < n; k++) {
+    if (errors[k])
+      std::rethrow_exception(errors[k]);
+  }
+
+  for (size_t k = 0; k < n; k++) {
+    for (auto p = results[k].begin(); p != results[k].end(); p++)
+      properties[p->first].append(p->second);
+  }
+}
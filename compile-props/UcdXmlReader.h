@@ -0,0 +1,122 @@
+#ifndef UCDXMLREADER_H
+#define UCDXMLREADER_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "PropertyAccumulator.h"
+#include "XmlReader.h"
+
+/// @brief Digests the code point records of a UCD XML file (UAX #42)
+/// into per-property accumulators.
+///
+/// Within the <repertoire> element, each <char>, <reserved>,
+/// <noncharacter> and <surrogate> record describes one code point (the
+/// cp attribute) or a range of them (first-cp and last-cp). Each other
+/// attribute gives the value of the property of that name. Records may
+/// be wrapped in a <group>, whose attributes supply the values of any
+/// properties that the record does not give itself.
+///
+/// Both the flat and the grouped forms of the UCD are handled, as are
+/// local files that use the same format to define custom properties.
+class UcdXmlReader : private XmlHandler {
+  public:
+    typedef std::map<std::string, PropertyAccumulator> PropertyMap;
+
+  private:
+    PropertyMap& m_properties;
+    std::set<std::string> m_selected;
+
+    bool m_inRepertoire;
+    std::vector<std::pair<PropertyAccumulator *, std::string> > m_groupValues;
+
+    // Records list their attributes in the same order almost every time,
+    // so the accumulator for the i'th attribute of the last record is
+    // remembered and checked before falling back to a map lookup.
+    struct Slot {
+      std::string name;
+      PropertyAccumulator *accumulator;
+    };
+    std::vector<Slot> m_slots;
+    std::vector<PropertyAccumulator *> m_recordAccumulators;
+
+    std::string m_source;
+    std::string m_decoded;
+
+    bool wants(const std::string& property) const;
+    PropertyAccumulator *accumulatorFor(const XmlString& name);
+    PropertyAccumulator *accumulatorFor(const XmlString& name, size_t slot);
+    void record(const std::vector<XmlAttribute>& attrs);
+    void readShard(const std::string& source,
+                   const char *begin, const char *end,
+                   const char *groupTag, const char *groupTagEnd);
+
+    void startElement(const XmlString& name,
+                      const std::vector<XmlAttribute>& attrs);
+    void endElement(const XmlString& name);
+
+  public:
+    /// @brief Accumulate into @p properties. If @p selected is non-empty,
+    /// only the named properties are collected; otherwise all properties
+    /// other than names, string mappings and Unihan fields are.
+    UcdXmlReader(PropertyMap& properties,
+                 const std::set<std::string>& selected);
+
+    /// @brief Read and digest @p path. Throws std::runtime_error if the
+    /// file cannot be read or is malformed.
+    void read(const std::string& path);
+
+    /// @brief Read and digest @p path like read(), but split the
+    /// repertoire into @p nShards contiguous pieces at record boundaries
+    /// and digest each piece on its own thread. The per-shard results
+    /// are appended to @p properties in code point order.
+    static void readSharded(const std::string& path,
+                            const std::set<std::string>& selected,
+                            unsigned nShards, PropertyMap& properties);
+
+    /// @brief Flush all accumulators once every input has been read.
+    void finish();
+};
+
+#endif // UCDXMLREADER_H
@@ -0,0 +1,253 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <sstream>
+#include <stdexcept>
+#include <stdlib.h>
+
+#include "XmlReader.h"
+#include "utf8.h"
+
+static inline bool
+isSpace(char c)
+{
+  return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r');
+}
+
+static inline bool
+isNameChar(char c)
+{
+  return !isSpace(c) && (c != '=') && (c != '>') && (c != '/') &&
+    (c != '"') && (c != '\'') && (c != '<');
+}
+
+void
+XmlReader::error(const char *at, const std::string& msg) const
+{
+  // Line numbers are only needed on the error path, so count them here
+  // rather than as we go.
+  unsigned line = 1;
+  for (const char *p = m_begin; p < at && p < m_end; p++) {
+    if (*p == '\n')
+      line++;
+  }
+
+  std::ostringstream os;
+  os << m_source << ':' << line << ": " << msg;
+  throw std::runtime_error(os.str());
+}
+
+const char *
+XmlReader::skipPast(const char *p, const char *terminator) const
+{
+  size_t n = strlen(terminator);
+  for (; p + n <= m_end; p++) {
+    if (memcmp(p, terminator, n) == 0)
+      return p + n;
+  }
+  error(p, std::string("unterminated construct; expected '") + terminator + "'");
+  return m_end;
+}
+
+const char *
+XmlReader::scanName(const char *p, XmlString& name) const
+{
+  const char *start = p;
+  while (p < m_end && isNameChar(*p))
+    p++;
+  if (p == start)
+    error(p, "expected a name");
+
+  name = XmlString(start, p - start);
+  return p;
+}
+
+void
+XmlReader::parse(XmlHandler& handler)
+{
+  const char *p = m_begin;
+
+  for (;;) {
+    p = static_cast<const char *>(memchr(p, '<', m_end - p));
+    if (!p)
+      return;
+
+    const char *tag = p++;
+    if (p == m_end)
+      error(tag, "truncated tag");
+
+    if (*p == '?') {
+      p = skipPast(p, "?>");
+      continue;
+    }
+    if (*p == '!') {
+      if ((m_end - p) >= 3 && memcmp(p, "!--", 3) == 0)
+        p = skipPast(p, "-->");
+      else if ((m_end - p) >= 8 && memcmp(p, "![CDATA[", 8) == 0)
+        p = skipPast(p, "]]>");
+      else {
+        // Document type declaration, possibly with an internal subset.
+        const char *gt = skipPast(p, ">");
+        const char *bracket = static_cast<const char *>(memchr(p, '[', gt - p));
+        p = bracket ? skipPast(skipPast(bracket, "]"), ">") : gt;
+      }
+      continue;
+    }
+
+    XmlString name;
+
+    if (*p == '/') {
+      p = scanName(p + 1, name);
+      while (p < m_end && isSpace(*p))
+        p++;
+      if (p == m_end || *p != '>')
+        error(tag, "malformed end tag");
+      p++;
+
+      const char *colon = static_cast<const char *>(memchr(name.data, ':', name.size));
+      if (colon)
+        name = XmlString(colon + 1, name.data + name.size - colon - 1);
+      handler.endElement(name);
+      continue;
+    }
+
+    p = scanName(p, name);
+    const char *colon = static_cast<const char *>(memchr(name.data, ':', name.size));
+    if (colon)
+      name = XmlString(colon + 1, name.data + name.size - colon - 1);
+
+    m_attrs.clear();
+    bool empty = false;
+
+    for (;;) {
+      while (p < m_end && isSpace(*p))
+        p++;
+      if (p == m_end)
+        error(tag, "unterminated tag");
+
+      if (*p == '>') {
+        p++;
+        break;
+      }
+      if (*p == '/') {
+        if (p + 1 == m_end || p[1] != '>')
+          error(p, "expected '/>'");
+        p += 2;
+        empty = true;
+        break;
+      }
+
+      XmlAttribute attr;
+      p = scanName(p, attr.name);
+      while (p < m_end && isSpace(*p))
+        p++;
+      if (p == m_end || *p != '=')
+        error(p, "expected '=' after attribute " + attr.name.str());
+      p++;
+      while (p < m_end && isSpace(*p))
+        p++;
+      if (p == m_end || (*p != '"' && *p != '\''))
+        error(p, "expected quoted value for attribute " + attr.name.str());
+
+      char quote = *p++;
+      const char *value = p;
+      p = static_cast<const char *>(memchr(p, quote, m_end - p));
+      if (!p)
+        error(value, "unterminated attribute value");
+      attr.value = XmlString(value, p - value);
+      p++;
+
+      m_attrs.push_back(attr);
+    }
+
+    handler.startElement(name, m_attrs);
+    if (empty)
+      handler.endElement(name);
+  }
+}
+
+std::string
+XmlReader::decode(const XmlString& raw)
+{
+  const char *amp = static_cast<const char *>(memchr(raw.data, '&', raw.size));
+  if (!amp)
+    return raw.str();
+
+  std::string result(raw.data, amp - raw.data);
+  const char *p = amp;
+  const char *end = raw.data + raw.size;
+
+  while (p < end) {
+    if (*p != '&') {
+      result += *p++;
+      continue;
+    }
+
+    const char *semi = static_cast<const char *>(memchr(p, ';', end - p));
+    if (!semi) {
+      result.append(p, end - p);
+      break;
+    }
+
+    std::string ref(p + 1, semi - p - 1);
+    if (ref == "lt")
+      result += '<';
+    else if (ref == "gt")
+      result += '>';
+    else if (ref == "amp")
+      result += '&';
+    else if (ref == "quot")
+      result += '"';
+    else if (ref == "apos")
+      result += '\'';
+    else if (ref.size() > 1 && ref[0] == '#') {
+      bool hex = (ref[1] == 'x' || ref[1] == 'X');
+      unsigned long cp = strtoul(ref.c_str() + (hex ? 2 : 1), 0, hex ? 16 : 10);
+      if (cp <= libucd::CODEPOINT_MAX)
+        result += libucd::utf8_encode(cp);
+    }
+    else {
+      // Unknown entity: keep it as written.
+      result.append(p, semi + 1 - p);
+    }
+
+    p = semi + 1;
+  }
+
+  return result;
+}
@@ -0,0 +1,121 @@
+#ifndef XMLREADER_H
+#define XMLREADER_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+/// @brief A span of characters within the document being parsed.
+struct XmlString {
+  const char *data;
+  size_t size;
+
+  XmlString() : data(0), size(0) {}
+  XmlString(const char *d, size_t n) : data(d), size(n) {}
+
+  bool operator == (const char *s) const
+  { return (strlen(s) == size) && (memcmp(data, s, size) == 0); }
+  bool operator != (const char *s) const
+  { return !(*this == s); }
+  bool operator == (const XmlString& s) const
+  { return (s.size == size) && (memcmp(data, s.data, size) == 0); }
+
+  std::string str() const { return std::string(data, size); }
+};
+
+/// @brief An attribute of a start tag. The value is raw: it may still
+/// contain entity and character references (see XmlReader::decode).
+struct XmlAttribute {
+  XmlString name;
+  XmlString value;
+};
+
+/// @brief Receiver for the events of an XmlReader.
+class XmlHandler {
+  public:
+    virtual ~XmlHandler() {}
+
+    /// @brief Called for each start tag and each empty-element tag. The
+    /// attribute vector is only valid for the duration of the call.
+    virtual void startElement(const XmlString& name,
+                              const std::vector<XmlAttribute>& attrs) = 0;
+
+    /// @brief Called for each end tag and after startElement() for each
+    /// empty-element tag.
+    virtual void endElement(const XmlString& name) = 0;
+};
+
+/// @brief A streaming (SAX-style) reader for the subset of XML used by
+/// the UCD files.
+///
+/// The reader makes a single forward pass over a buffer, typically a
+/// MappedFile, and reports elements to an XmlHandler as it goes. Nothing
+/// is copied: names and attribute values refer directly into the
+/// buffer. Character data, comments, processing instructions, CDATA
+/// sections and the document type declaration are skipped. Namespace
+/// prefixes are stripped from element names.
+class XmlReader {
+    const char *m_begin;
+    const char *m_end;
+    std::string m_source;
+    std::vector<XmlAttribute> m_attrs;
+
+    void error(const char *at, const std::string& msg) const;
+    const char *skipPast(const char *p, const char *terminator) const;
+    const char *scanName(const char *p, XmlString& name) const;
+
+  public:
+    /// @brief Prepare to parse [@p begin, @p end). @p source names the
+    /// document in error messages.
+    XmlReader(const char *begin, const char *end, const std::string& source)
+      : m_begin(begin), m_end(end), m_source(source) {}
+
+    /// @brief Parse the whole document, reporting to @p handler. Throws
+    /// std::runtime_error if the document is malformed.
+    void parse(XmlHandler& handler);
+
+    /// @brief Return @p raw with entity and character references
+    /// replaced by the characters they denote.
+    static std::string decode(const XmlString& raw);
+};
+
+#endif // XMLREADER_H
@@ -1,6 +1,22 @@
 TEMPLATE = app
-CONFIG += console c++11
+CONFIG += console c++11 thread
 CONFIG -= app_bundle
 CONFIG -= qt
 
-SOURCES += main.cpp
+INCLUDEPATH += ../lang/c++/libucd
+LIBS += -L$$OUT_PWD/../lang/c++/libucd -llibucd
+PRE_TARGETDEPS += $$OUT_PWD/../lang/c++/libucd/liblibucd.a
+
+SOURCES += main.cpp \
+    PropertyAccumulator.cpp \
+    PropertyCache.cpp \
+    Sha256.cpp \
+    UcdXmlReader.cpp \
+    XmlReader.cpp
+
+HEADERS += \
+    PropertyAccumulator.h \
+    PropertyCache.h \
+    Sha256.h \
+    UcdXmlReader.h \
+    XmlReader.h
@@ -1,9 +1,321 @@
+#include <fstream>
+#include <iterator>
 #include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AliasFile.h"
+#include "PropertyCache.h"
+#include "UcdDatabaseWriter.h"
+#include "UcdXmlReader.h"
 
 using namespace std;
+using namespace libucd;
+
+static void
+usage(ostream& os)
+{
+  os << "Usage: compile-props [-j N] [-p PROP]... [--binary] [OPTIONS] -o OUTPUT FILE..." << endl
+     << endl
+     << "Digest the UCD XML FILEs (e.g. ucd.all.flat.xml, followed by any" << endl
+     << "local custom property files) and write a C++ source file holding" << endl
+     << "the code point ranges of every value of every property." << endl
+     << endl
+     << "  -p PROP     collect only property PROP (may be repeated). By" << endl
+     << "              default, all properties except names, string" << endl
+     << "              mappings and Unihan fields are collected." << endl
+     << "  -o OUTPUT   output file" << endl
+     << "  -j N        digest each file with N threads, each taking a" << endl
+     << "              contiguous shard of the code points (default: one" << endl
+     << "              per core)" << endl
+     << "  --binary    write a binary property database, which libucd's" << endl
+     << "              UcdDatabase maps and queries in place, instead of" << endl
+     << "              C++ source" << endl
+     << "  --cache DIR keep the digest of each property of each input in" << endl
+     << "              DIR, keyed by a hash of the input's contents, and" << endl
+     << "              re-digest only the properties of inputs that have" << endl
+     << "              changed" << endl
+     << endl
+     << "OUTPUT is only rewritten if its contents change." << endl
+     << endl
+     << "Binary database options:" << endl
+     << "  --property-aliases FILE   record the aliases in FILE, in the" << endl
+     << "                            format of PropertyAliases.txt" << endl
+     << "  --value-aliases FILE      record the aliases in FILE, in the" << endl
+     << "                            format of PropertyValueAliases.txt" << endl
+     << "  --unicode-version V       record V as the Unicode version" << endl;
+}
+
+// Write /s/ as a C++ string literal.
+static void
+emitString(ostream& os, const string& s)
+{
+  os << '"';
+  for (size_t i = 0; i < s.size(); i++) {
+    unsigned char c = s[i];
+    if (c == '"' || c == '\\')
+      os << '\\' << c;
+    else if (c < 0x20 || c == 0x7f) {
+      const char *digits = "01234567";
+      os << '\\' << digits[(c >> 6) & 7] << digits[(c >> 3) & 7] << digits[c & 7];
+    }
+    else
+      os << c;
+  }
+  os << '"';
+}
+
+static void
+emitDatabase(ostream& os, const UcdXmlReader::PropertyMap& properties)
+{
+  os << "// Generated by compile-props. DO NOT EDIT." << endl
+     << endl
+     << "#include \"CodePointRangeTable.h\"" << endl
+     << endl
+     << "namespace ucd_db {" << endl
+     << endl
+     << "struct PropertyValueRanges {" << endl
+     << "  const char *property;" << endl
+     << "  const char *value;" << endl
+     << "  libucd::CodePointRangeTable ranges;" << endl
+     << "};" << endl
+     << endl;
+
+  size_t n = 0;
+  for (auto p = properties.begin(); p != properties.end(); p++) {
+    for (auto v = p->second.values().begin(); v != p->second.values().end(); v++) {
+      os << "// " << p->first << "=" << v->first << endl
+         << "static constexpr libucd::CodePointRange ranges_" << n++ << "[] = {"
+         << endl << hex;
+      for (auto r = v->second.begin(); r != v->second.end(); r++)
+        os << "  { 0x" << r->min() << ", 0x" << r->max() << " }," << endl;
+      os << dec << "};" << endl << endl;
+    }
+  }
+
+  os << "extern const PropertyValueRanges property_values[] = {" << endl;
+  n = 0;
+  for (auto p = properties.begin(); p != properties.end(); p++) {
+    for (auto v = p->second.values().begin(); v != p->second.values().end(); v++) {
+      os << "  { ";
+      emitString(os, p->first);
+      os << ", ";
+      emitString(os, v->first);
+      os << ", libucd::CodePointRangeTable(ranges_" << n++ << ") }," << endl;
+    }
+  }
+  os << "};" << endl
+     << endl
+     << "extern const size_t property_values_count = " << n << ";" << endl
+     << endl
+     << "} // namespace ucd_db" << endl;
+}
+
+// Replace /path/ with /data/ unless it already holds exactly that, so
+// that an unchanged database does not trigger downstream rebuilds.
+static bool
+writeIfChanged(const string& path, const string& data)
+{
+  {
+    ifstream in(path.c_str(), ios::binary);
+    if (in) {
+      string old((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+      if (old == data)
+        return false;
+    }
+  }
+
+  ofstream os(path.c_str(), ios::binary);
+  if (!os)
+    throw runtime_error(path + ": cannot create");
+  os.write(data.data(), data.size());
+  os.close();
+  if (!os)
+    throw runtime_error(path + ": write error");
+  return true;
+}
+
+// Digest /path/ into /properties/, taking whatever the cache has for it
+// and storing what it lacked. Returns true if the file had to be read.
+static bool
+readCached(const PropertyCache& cache, const string& path,
+           const set<string>& selected, unsigned jobs,
+           UcdXmlReader::PropertyMap& properties)
+{
+  PropertyCache::Hash hash = PropertyCache::hashFile(path);
+
+  vector<string> defined;
+  bool haveManifest = cache.loadManifest(hash, selected, defined);
+
+  set<string> missing;
+  if (haveManifest) {
+    for (size_t i = 0; i < defined.size(); i++) {
+      PropertyAccumulator::ValueMap values;
+      if (cache.loadFragment(hash, defined[i], values))
+        properties[defined[i]].append(values);
+      else
+        missing.insert(defined[i]);
+    }
+    if (missing.empty())
+      return false;
+  }
+
+  // Without a manifest we do not know what the file defines, so it is
+  // digested in full; otherwise only the properties the cache lacked.
+  UcdXmlReader::PropertyMap digested;
+  UcdXmlReader::readSharded(path, haveManifest ? missing : selected, jobs,
+                            digested);
+
+  for (auto p = digested.begin(); p != digested.end(); p++) {
+    p->second.finish();
+    cache.storeFragment(hash, p->first, p->second.values());
+    properties[p->first].append(p->second);
+  }
+
+  if (!haveManifest) {
+    for (auto p = digested.begin(); p != digested.end(); p++)
+      defined.push_back(p->first);
+    cache.storeManifest(hash, selected, defined);
+  }
+
+  return true;
+}
+
+static string
+binaryDatabase(const UcdXmlReader::PropertyMap& properties,
+               const vector<string>& propertyAliases,
+               const vector<string>& valueAliases,
+               const string& unicodeVersion)
+{
+  UcdDatabaseWriter writer;
+  writer.setUnicodeVersion(unicodeVersion);
+
+  for (auto p = properties.begin(); p != properties.end(); p++)
+    writer.addProperty(p->first, p->second.values());
+
+  for (size_t f = 0; f < propertyAliases.size(); f++) {
+    vector<vector<string> > records = readAliasFile(propertyAliases[f]);
+    for (size_t r = 0; r < records.size(); r++) {
+      for (size_t i = 1; i < records[r].size(); i++)
+        writer.addPropertyAlias(records[r][0], records[r][i]);
+    }
+  }
+
+  for (size_t f = 0; f < valueAliases.size(); f++) {
+    vector<vector<string> > records = readAliasFile(valueAliases[f]);
+    for (size_t r = 0; r < records.size(); r++) {
+      for (size_t i = 2; i < records[r].size(); i++)
+        writer.addValueAlias(records[r][0], records[r][1], records[r][i]);
+    }
+  }
+
+  return writer.serialize();
+}
 
 int main(int argc, char *argv[])
 {
-  cout << "Hello World!" << endl;
+  set<string> selected;
+  string output;
+  vector<string> inputs;
+  unsigned jobs = thread::hardware_concurrency();
+  bool binary = false;
+  vector<string> propertyAliases;
+  vector<string> valueAliases;
+  string unicodeVersion;
+  string cacheDir;
+
+  for (int i = 1; i < argc; i++) {
+    string arg = argv[i];
+    if ((arg == "-p" || arg == "-o" || arg == "-j") && i + 1 < argc) {
+      if (arg == "-p")
+        selected.insert(argv[++i]);
+      else if (arg == "-o")
+        output = argv[++i];
+      else
+        jobs = strtoul(argv[++i], 0, 10);
+    }
+    else if (arg == "--binary") {
+      binary = true;
+    }
+    else if (arg == "--property-aliases" && i + 1 < argc) {
+      propertyAliases.push_back(argv[++i]);
+    }
+    else if (arg == "--value-aliases" && i + 1 < argc) {
+      valueAliases.push_back(argv[++i]);
+    }
+    else if (arg == "--unicode-version" && i + 1 < argc) {
+      unicodeVersion = argv[++i];
+    }
+    else if (arg == "--cache" && i + 1 < argc) {
+      cacheDir = argv[++i];
+    }
+    else if (arg == "-h" || arg == "--help") {
+      usage(cout);
+      return 0;
+    }
+    else if (arg.size() > 1 && arg[0] == '-') {
+      usage(cerr);
+      return 1;
+    }
+    else
+      inputs.push_back(arg);
+  }
+
+  if (output.empty() || inputs.empty()) {
+    usage(cerr);
+    return 1;
+  }
+
+  try {
+    UcdXmlReader::PropertyMap properties;
+
+    if (cacheDir.empty()) {
+      for (size_t i = 0; i < inputs.size(); i++)
+        UcdXmlReader::readSharded(inputs[i], selected, jobs, properties);
+    }
+    else {
+      PropertyCache cache(cacheDir);
+      size_t nRead = 0;
+      for (size_t i = 0; i < inputs.size(); i++)
+        nRead += readCached(cache, inputs[i], selected, jobs, properties);
+      cerr << "compile-props: " << (inputs.size() - nRead) << " of "
+           << inputs.size() << " inputs fully cached" << endl;
+    }
+    for (auto p = properties.begin(); p != properties.end(); p++)
+      p->second.finish();
+
+    string data;
+    if (binary) {
+      data = binaryDatabase(properties, propertyAliases, valueAliases,
+                            unicodeVersion);
+    }
+    else {
+      ostringstream os;
+      emitDatabase(os, properties);
+      data = os.str();
+    }
+    if (!writeIfChanged(output, data))
+      cerr << "compile-props: " << output << " is unchanged" << endl;
+
+    size_t nValues = 0;
+    size_t nRanges = 0;
+    for (auto p = properties.begin(); p != properties.end(); p++) {
+      nValues += p->second.values().size();
+      for (auto v = p->second.values().begin(); v != p->second.values().end(); v++)
+        nRanges += v->second.size();
+    }
+    cerr << "compile-props: " << properties.size() << " properties, "
+         << nValues << " values, " << nRanges << " ranges" << endl;
+  }
+  catch (const exception& ex) {
+    cerr << "compile-props: " << ex.what() << endl;
+    return 1;
+  }
+
   return 0;
 }
@@ -0,0 +1,324 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#include "AliasHash.h"
+#include "LooseMatch.h"
+#include "MultiStageTable.h"
+
+using libucd::loose_equal;
+using libucd::loose_fold;
+using libucd::loose_hash;
+using libucd::loose_ignored;
+using libucd::loose_mix;
+using libucd::loose_start;
+
+// Displacements are searched up to this bound before the seed is
+// changed. Keeping them below 2^16 keeps the emitted array small.
+static const uint32_t MAX_DISPLACEMENT = UINT16_MAX;
+static const unsigned MAX_SEEDS = 64;
+
+// Average number of keys per bucket. Larger buckets make a smaller
+// displacement array but a longer search.
+static const size_t BUCKET_LOAD = 4;
+
+static uint32_t
+maxOf(const std::vector<uint32_t>& v)
+{
+  return v.empty() ? 0 : *std::max_element(v.begin(), v.end());
+}
+
+// Print /values/ as the initializer of a C array, wrapped at 78 columns.
+static void
+emitArray(std::ostream& os, const std::string& declaration,
+          const std::vector<uint32_t>& values)
+{
+  os << declaration << "[" << values.size() << "] = {";
+
+  size_t column = 80;
+  for (size_t i = 0; i < values.size(); i++) {
+    std::ostringstream item;
+    item << values[i] << ',';
+    if (column + item.str().size() + 1 > 78) {
+      os << std::endl << "  ";
+      column = 2;
+    }
+    else {
+      os << ' ';
+      column++;
+    }
+    os << item.str();
+    column += item.str().size();
+  }
+  os << std::endl << "};" << std::endl << std::endl;
+}
+
+std::string
+AliasHash::looseKey(const std::string& name)
+{
+  std::string key;
+  for (size_t i = loose_start(name.data(), name.size()); i < name.size(); i++) {
+    if (!loose_ignored(name[i]))
+      key += char(loose_fold(name[i]));
+  }
+  return key;
+}
+
+AliasHash::AliasHash(const std::vector<Alias>& aliases)
+{
+  // Merge the aliases that match loosely. The first spelling of each
+  // key is kept for hashing: the key itself may not hash alike, since
+  // an "is" left at its start would be stripped again.
+  std::map<std::pair<uint32_t, std::string>, const Alias *> merged;
+  std::vector<const Alias *> unique;
+
+  for (size_t i = 0; i < aliases.size(); i++) {
+    const Alias& a = aliases[i];
+    auto ins = merged.insert({ { a.scope, looseKey(a.name) }, &a });
+    if (ins.second)
+      unique.push_back(&a);
+    else if (ins.first->second->target != a.target)
+      throw std::runtime_error("aliases '" + ins.first->second->name +
+                               "' and '" + a.name +
+                               "' match loosely but name different values");
+  }
+
+  if (unique.empty())
+    throw std::runtime_error("no aliases to hash");
+
+  std::vector<uint64_t> hashes(unique.size());
+
+  for (unsigned attempt = 0; attempt < MAX_SEEDS; attempt++) {
+    m_seed = loose_mix(attempt);
+    for (size_t i = 0; i < unique.size(); i++)
+      hashes[i] = loose_hash(unique[i]->name.data(), unique[i]->name.size(),
+                             m_seed + unique[i]->scope);
+    if (!place(hashes))
+      continue;
+
+    // place() filled m_slots with indices into unique; fill them in.
+    for (size_t s = 0; s < m_slots.size(); s++) {
+      const Alias& a = *unique[m_slots[s].target];
+      m_slots[s].scope = a.scope;
+      m_slots[s].name = looseKey(a.name);
+      m_slots[s].target = a.target;
+    }
+    return;
+  }
+
+  throw std::runtime_error("cannot find a perfect hash for the aliases");
+}
+
+// Assign displacements so that every key lands in a slot of its own.
+// Returns false if some bucket cannot be placed.
+bool
+AliasHash::place(const std::vector<uint64_t>& hashes)
+{
+  const size_t n = hashes.size();
+  const size_t nBuckets = (n + BUCKET_LOAD - 1) / BUCKET_LOAD;
+
+  std::vector<std::vector<size_t> > buckets(nBuckets);
+  for (size_t i = 0; i < n; i++)
+    buckets[hashes[i] % nBuckets].push_back(i);
+
+  std::vector<size_t> order(nBuckets);
+  for (size_t b = 0; b < nBuckets; b++)
+    order[b] = b;
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return buckets[a].size() > buckets[b].size();
+    });
+
+  std::vector<bool> taken(n, false);
+  std::vector<size_t> slots;
+  m_displacements.assign(nBuckets, 0);
+  m_slots.assign(n, Alias());
+
+  for (size_t o = 0; o < nBuckets; o++) {
+    const std::vector<size_t>& bucket = buckets[order[o]];
+    if (bucket.empty())
+      break;
+
+    uint32_t d = 0;
+    for (;; d++) {
+      if (d > MAX_DISPLACEMENT)
+        return false;
+
+      slots.clear();
+      for (size_t k = 0; k < bucket.size(); k++) {
+        size_t s = loose_mix(hashes[bucket[k]] + d) % n;
+        if (taken[s] || std::find(slots.begin(), slots.end(), s) != slots.end())
+          break;
+        slots.push_back(s);
+      }
+      if (slots.size() == bucket.size())
+        break;
+    }
+
+    m_displacements[order[o]] = d;
+    for (size_t k = 0; k < bucket.size(); k++) {
+      taken[slots[k]] = true;
+      m_slots[slots[k]].target = uint32_t(bucket[k]);
+    }
+  }
+
+  return true;
+}
+
+int
+AliasHash::lookup(uint32_t scope, const std::string& name) const
+{
+  uint64_t h = loose_hash(name.data(), name.size(), m_seed + scope);
+  uint32_t d = m_displacements[h % m_displacements.size()];
+  const Alias& slot = m_slots[loose_mix(h + d) % m_slots.size()];
+
+  if (slot.scope != scope || !loose_equal(name.data(), name.size(), slot.name.c_str()))
+    return -1;
+  return int(slot.target);
+}
+
+// Sizes of the emitted slot fields: scope, target and key offset.
+static void
+slotFields(const std::vector<AliasHash::Alias>& slots,
+           uint32_t& maxScope, uint32_t& maxTarget, uint32_t& keyBytes)
+{
+  maxScope = maxTarget = keyBytes = 0;
+  for (size_t s = 0; s < slots.size(); s++) {
+    maxScope = std::max(maxScope, slots[s].scope);
+    maxTarget = std::max(maxTarget, slots[s].target);
+    keyBytes += uint32_t(slots[s].name.size() + 1);
+  }
+}
+
+size_t
+AliasHash::byteSize() const
+{
+  uint32_t maxScope, maxTarget, keyBytes;
+  slotFields(m_slots, maxScope, maxTarget, keyBytes);
+
+  size_t slotSize = MultiStageTable::elementSize(maxScope)
+    + MultiStageTable::elementSize(maxTarget)
+    + MultiStageTable::elementSize(keyBytes);
+  size_t align = std::max(MultiStageTable::elementSize(maxScope),
+                          std::max(MultiStageTable::elementSize(maxTarget),
+                                   MultiStageTable::elementSize(keyBytes)));
+  slotSize = (slotSize + align - 1) / align * align;
+
+  return m_displacements.size() * MultiStageTable::elementSize(maxOf(m_displacements))
+    + m_slots.size() * slotSize + keyBytes;
+}
+
+void
+AliasHash::report(std::ostream& os, const std::string& name) const
+{
+  os << name << ": perfect hash of " << m_slots.size() << " keys, "
+     << byteSize() << " bytes" << std::endl
+     << "  " << m_displacements.size() << " buckets, largest displacement "
+     << maxOf(m_displacements) << std::endl;
+}
+
+void
+AliasHash::emitDefinitions(std::ostream& os, const std::string& name) const
+{
+  uint32_t maxScope, maxTarget, keyBytes;
+  slotFields(m_slots, maxScope, maxTarget, keyBytes);
+
+  os << "struct " << name << "_slot {" << std::endl
+     << "  " << MultiStageTable::elementType(maxScope) << " scope;" << std::endl
+     << "  " << MultiStageTable::elementType(maxTarget) << " target;" << std::endl
+     << "  " << MultiStageTable::elementType(keyBytes) << " key;" << std::endl
+     << "};" << std::endl << std::endl;
+
+  emitArray(os, std::string("static const ")
+            + MultiStageTable::elementType(maxOf(m_displacements)) + ' '
+            + name + "_displacements", m_displacements);
+
+  os << "static const " << name << "_slot " << name << "_slots["
+     << m_slots.size() << "] = {" << std::endl;
+  uint32_t offset = 0;
+  for (size_t s = 0; s < m_slots.size(); s++) {
+    os << "  { " << m_slots[s].scope << ", " << m_slots[s].target << ", "
+       << offset << " }," << std::endl;
+    offset += uint32_t(m_slots[s].name.size() + 1);
+  }
+  os << "};" << std::endl << std::endl;
+
+  // One literal per key; adjacent literals are joined after escapes are
+  // read, so a key starting with a digit does not extend the "\0".
+  os << "static const char " << name << "_keys[] =" << std::endl;
+  for (size_t s = 0; s < m_slots.size(); s++) {
+    os << "  \"";
+    const std::string& key = m_slots[s].name;
+    for (size_t i = 0; i < key.size(); i++) {
+      unsigned char c = key[i];
+      if (c == '"' || c == '\\')
+        os << '\\' << c;
+      else if (c < 0x20 || c >= 0x7f)
+        os << '\\' << std::oct << std::setw(3) << std::setfill('0') << unsigned(c)
+           << std::dec << std::setfill(' ');
+      else
+        os << c;
+    }
+    os << "\\0\"";
+    if (s + 1 == m_slots.size())
+      os << ";";
+    os << std::endl;
+  }
+  os << std::endl;
+
+  os << "static int" << std::endl
+     << name << "_lookup(unsigned scope, const char *s, size_t len)" << std::endl
+     << "{" << std::endl
+     << "  uint64_t h = libucd::loose_hash(s, len, UINT64_C(0x" << std::hex
+     << m_seed << std::dec << ") + scope);" << std::endl
+     << "  uint32_t d = " << name << "_displacements[h % "
+     << m_displacements.size() << "];" << std::endl
+     << "  const " << name << "_slot& slot = " << name
+     << "_slots[libucd::loose_mix(h + d) % " << m_slots.size() << "];"
+     << std::endl << std::endl
+     << "  if (slot.scope != scope ||" << std::endl
+     << "      !libucd::loose_equal(s, len, " << name << "_keys + slot.key))"
+     << std::endl
+     << "    return -1;" << std::endl
+     << "  return slot.target;" << std::endl
+     << "}" << std::endl << std::endl;
+}
@@ -0,0 +1,107 @@
+#ifndef ALIASHASH_H
+#define ALIASHASH_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <ostream>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/// @brief A minimal perfect hash from loosely matched names to numbers,
+/// for resolving property and property value aliases.
+///
+/// Each alias belongs to a numbered scope (e.g. "the property names" or
+/// "the values of General_Category") and maps to a target number within
+/// it. Names are compared by UAX44-LM3 loose matching (see LooseMatch.h),
+/// so "Lu", "uppercase letter" and "isUppercase_Letter" are one key.
+///
+/// The table is built by hash and displace: keys are hashed once into
+/// buckets, and each bucket, largest first, is given the smallest
+/// displacement that sends all of its keys to free slots. A lookup is
+/// then one hash of the name, two array loads and one loose comparison
+/// against the single candidate slot, with no allocation and no
+/// normalization of the name.
+class AliasHash {
+  public:
+    struct Alias {
+      uint32_t scope;
+      std::string name;
+      uint32_t target;
+    };
+
+  private:
+    uint64_t m_seed;
+    std::vector<Alias> m_slots;  // names held in loose form
+    std::vector<uint32_t> m_displacements;
+
+    bool place(const std::vector<uint64_t>& hashes);
+
+  public:
+    /// @brief Build a table over @p aliases. Aliases that match
+    /// loosely within a scope must have the same target; duplicates are
+    /// dropped and conflicts throw std::runtime_error.
+    AliasHash(const std::vector<Alias>& aliases);
+
+    /// @brief @p name in loose form: ASCII lower case, without
+    /// whitespace, underscores, hyphens or an initial "is".
+    static std::string looseKey(const std::string& name);
+
+    /// @brief Target of @p name in @p scope, or -1. Used to check the
+    /// built table.
+    int lookup(uint32_t scope, const std::string& name) const;
+
+    /// @brief Number of distinct keys.
+    size_t size() const
+    { return m_slots.size(); }
+
+    /// @brief Total size in bytes of the emitted arrays and strings.
+    size_t byteSize() const;
+
+    /// @brief Describe the shape and size of the table.
+    void report(std::ostream& os, const std::string& name) const;
+
+    /// @brief Emit the table arrays and a static function
+    /// int @p name_lookup(unsigned scope, const char *s, size_t len)
+    /// returning the target of [s, s + len) in scope, or -1.
+    void emitDefinitions(std::ostream& os, const std::string& name) const;
+};
+
+#endif // ALIASHASH_H
@@ -0,0 +1,115 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <ctype.h>
+#include <stdexcept>
+
+#include "GeneratedFiles.h"
+
+GeneratedFiles::GeneratedFiles(const std::string& base,
+                               const std::string& nameSpace,
+                               const std::string& description,
+                               const std::vector<std::string>& headerIncludes,
+                               const std::string& sourcePreamble)
+  : m_base(base), m_namespace(nameSpace)
+{
+  std::string name = baseName(base);
+
+  for (size_t i = 0; i < name.size(); i++)
+    m_guard += isalnum((unsigned char) name[i]) ? toupper((unsigned char) name[i]) : '_';
+  m_guard += "_H";
+
+  m_header.open((base + ".h").c_str());
+  m_source.open((base + ".cpp").c_str());
+  if (!m_header || !m_source)
+    throw std::runtime_error(base + ": cannot create output files");
+
+  const char *banner =
+    "// Generated by gen-props. DO NOT EDIT.\n";
+
+  m_header << "#ifndef " << m_guard << "\n"
+           << "#define " << m_guard << "\n\n"
+           << banner << "//\n// " << description << "\n\n";
+  for (size_t i = 0; i < headerIncludes.size(); i++)
+    m_header << "#include " << headerIncludes[i] << "\n";
+  m_header << "\nnamespace " << m_namespace << " {\n\n";
+
+  m_source << banner << "//\n// " << description << "\n\n"
+           << "#include \"" << name << ".h\"\n\n";
+  if (!sourcePreamble.empty())
+    m_source << sourcePreamble << "\n";
+  m_source << "namespace " << m_namespace << " {\n\n";
+}
+
+GeneratedFiles::~GeneratedFiles()
+{
+}
+
+void
+GeneratedFiles::close()
+{
+  m_header << "} // namespace " << m_namespace << "\n\n"
+           << "#endif // " << m_guard << "\n";
+  m_source << "} // namespace " << m_namespace << "\n";
+
+  m_header.close();
+  m_source.close();
+  if (!m_header || !m_source)
+    throw std::runtime_error(m_base + ": error writing output files");
+}
+
+std::string
+GeneratedFiles::identifier(const std::string& name)
+{
+  std::string id;
+
+  for (size_t i = 0; i < name.size(); i++)
+    id += isalnum((unsigned char) name[i]) ? name[i] : '_';
+
+  if (id.empty() || isdigit((unsigned char) id[0]))
+    id = "_" + id;
+
+  return id;
+}
+
+std::string
+GeneratedFiles::baseName(const std::string& path)
+{
+  size_t slash = path.find_last_of('/');
+  return (slash == std::string::npos) ? path : path.substr(slash + 1);
+}
@@ -0,0 +1,85 @@
+#ifndef GENERATEDFILES_H
+#define GENERATEDFILES_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+/// @brief The header/source pair written by one gen-props command.
+///
+/// Opening a GeneratedFiles writes the common preamble to @p base.h and
+/// @p base.cpp: a do-not-edit banner, the include guard, the requested
+/// includes, and the opening of the target namespace. close() writes
+/// the matching epilogue. Everything in between is up to the caller.
+///
+/// @p sourcePreamble, if given, is written to the source file after its
+/// own header is included and before the namespace is opened, for
+/// includes and macros that only the source needs.
+class GeneratedFiles {
+    std::string m_base;
+    std::string m_namespace;
+    std::string m_guard;
+    std::ofstream m_header;
+    std::ofstream m_source;
+
+  public:
+    GeneratedFiles(const std::string& base, const std::string& nameSpace,
+                   const std::string& description,
+                   const std::vector<std::string>& headerIncludes,
+                   const std::string& sourcePreamble = std::string());
+    ~GeneratedFiles();
+
+    std::ostream& header() { return m_header; }
+    std::ostream& source() { return m_source; }
+
+    /// @brief Write the epilogues and close both files. Throws
+    /// std::runtime_error if either could not be written.
+    void close();
+
+    /// @brief Turn a UCD property or value name into a valid C++
+    /// identifier.
+    static std::string identifier(const std::string& name);
+
+    /// @brief The last component of @p path.
+    static std::string baseName(const std::string& path);
+};
+
+#endif // GENERATEDFILES_H
@@ -0,0 +1,269 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#include "MultiStageTable.h"
+
+static const size_t CODESPACE_SIZE = 0x110000;
+
+// Cut /level/ into blocks of 2^bits entries, append each distinct block
+// to /data/ exactly once, and return the block index of each block of
+// /level/ within /data/.
+static std::vector<uint32_t>
+dedupBlocks(const std::vector<uint32_t>& level, unsigned bits,
+            std::vector<uint32_t>& data)
+{
+  const size_t blockSize = size_t(1) << bits;
+  std::map<std::vector<uint32_t>, uint32_t> seen;
+  std::vector<uint32_t> index;
+
+  index.reserve(level.size() / blockSize);
+
+  for (size_t i = 0; i < level.size(); i += blockSize) {
+    std::vector<uint32_t> block(level.begin() + i,
+                                level.begin() + i + blockSize);
+    auto it = seen.find(block);
+    if (it == seen.end()) {
+      it = seen.insert({ block, uint32_t(data.size() >> bits) }).first;
+      data.insert(data.end(), block.begin(), block.end());
+    }
+    index.push_back(it->second);
+  }
+
+  return index;
+}
+
+static uint32_t
+maxElement(const std::vector<uint32_t>& v)
+{
+  uint32_t m = 0;
+  for (size_t i = 0; i < v.size(); i++)
+    m = std::max(m, v[i]);
+  return m;
+}
+
+MultiStageTable::MultiStageTable(const std::vector<uint32_t>& values,
+                                 unsigned leafBits, unsigned indexBits)
+{
+  // 0x110000 is 17 * 2^16, so every level divides evenly into blocks
+  // as long as the blocks together cover no more than 16 bits.
+  if (values.size() != CODESPACE_SIZE)
+    throw std::invalid_argument("MultiStageTable: need one value per code point");
+  if (leafBits == 0 || leafBits + indexBits > 16)
+    throw std::invalid_argument("MultiStageTable: bad block size");
+
+  std::vector<uint32_t> leaf;
+  std::vector<uint32_t> index = dedupBlocks(values, leafBits, leaf);
+
+  if (indexBits) {
+    std::vector<uint32_t> middle;
+    std::vector<uint32_t> top = dedupBlocks(index, indexBits, middle);
+    m_stages = { top, middle, leaf };
+    m_bits = { indexBits, leafBits };
+  }
+  else {
+    m_stages = { index, leaf };
+    m_bits = { leafBits };
+  }
+}
+
+MultiStageTable
+MultiStageTable::smallest(const std::vector<uint32_t>& values,
+                          unsigned nStages)
+{
+  std::vector<MultiStageTable> candidates;
+
+  if (nStages == 2) {
+    for (unsigned leaf = 4; leaf <= 12; leaf++)
+      candidates.push_back(MultiStageTable(values, leaf));
+  }
+  else if (nStages == 3) {
+    for (unsigned leaf = 3; leaf <= 10; leaf++)
+      for (unsigned index = 2; index <= 8 && leaf + index <= 16; index++)
+        candidates.push_back(MultiStageTable(values, leaf, index));
+  }
+  else {
+    throw std::invalid_argument("MultiStageTable: need 2 or 3 stages");
+  }
+
+  size_t best = 0;
+  for (size_t i = 1; i < candidates.size(); i++) {
+    if (candidates[i].byteSize() < candidates[best].byteSize())
+      best = i;
+  }
+
+  return candidates[best];
+}
+
+uint32_t
+MultiStageTable::lookup(uint32_t cp) const
+{
+  unsigned shift = 0;
+  for (size_t s = 0; s < m_bits.size(); s++)
+    shift += m_bits[s];
+
+  uint32_t i = m_stages[0][cp >> shift];
+  for (size_t s = 1; s < m_stages.size(); s++) {
+    unsigned bits = m_bits[s - 1];
+    shift -= bits;
+    i = m_stages[s][(i << bits) | ((cp >> shift) & ((1u << bits) - 1))];
+  }
+
+  return i;
+}
+
+const char *
+MultiStageTable::elementType(uint32_t maxValue)
+{
+  if (maxValue <= UINT8_MAX)
+    return "uint8_t";
+  if (maxValue <= UINT16_MAX)
+    return "uint16_t";
+  return "uint32_t";
+}
+
+size_t
+MultiStageTable::elementSize(uint32_t maxValue)
+{
+  if (maxValue <= UINT8_MAX)
+    return 1;
+  if (maxValue <= UINT16_MAX)
+    return 2;
+  return 4;
+}
+
+size_t
+MultiStageTable::byteSize() const
+{
+  size_t size = 0;
+  for (size_t s = 0; s < m_stages.size(); s++)
+    size += m_stages[s].size() * elementSize(maxElement(m_stages[s]));
+  return size;
+}
+
+void
+MultiStageTable::report(std::ostream& os, const std::string& name) const
+{
+  os << name << ": " << m_stages.size() << "-stage table, "
+     << byteSize() << " bytes" << std::endl;
+
+  for (size_t s = 0; s < m_stages.size(); s++) {
+    uint32_t maxValue = maxElement(m_stages[s]);
+    os << "  stage " << s << ": " << m_stages[s].size() << " x "
+       << elementType(maxValue);
+    if (s > 0)
+      os << " (" << (m_stages[s].size() >> m_bits[s - 1])
+         << " distinct blocks of " << (1u << m_bits[s - 1]) << ")";
+    os << std::endl;
+  }
+}
+
+void
+MultiStageTable::emitDeclarations(std::ostream& os, const std::string& name,
+                                  const std::string& function,
+                                  const std::string& valueType) const
+{
+  for (size_t s = 0; s < m_stages.size(); s++)
+    os << "extern const " << elementType(maxElement(m_stages[s])) << ' '
+       << name << "_stage" << s << "[" << m_stages[s].size() << "];"
+       << std::endl;
+  os << std::endl;
+
+  unsigned shift = 0;
+  for (size_t s = 0; s < m_bits.size(); s++)
+    shift += m_bits[s];
+
+  std::ostringstream expr;
+  expr << name << "_stage0[cp >> " << shift << "]";
+
+  for (size_t s = 1; s < m_stages.size(); s++) {
+    unsigned bits = m_bits[s - 1];
+    shift -= bits;
+
+    std::ostringstream next;
+    next << name << "_stage" << s << "[(" << expr.str() << " << " << bits
+         << ") | (";
+    if (shift)
+      next << "(cp >> " << shift << ") & ";
+    else
+      next << "cp & ";
+    next << "0x" << std::hex << ((1u << bits) - 1) << std::dec << ")]";
+    expr.str(next.str());
+  }
+
+  os << "/// @brief Look up the value of " << name << " for @p cp, which"
+     << std::endl
+     << "/// must not exceed libucd::CODEPOINT_MAX." << std::endl
+     << "inline " << valueType << std::endl
+     << function << "(libucd::CodePoint_t cp)" << std::endl
+     << "{" << std::endl
+     << "  return " << valueType << "(" << expr.str() << ");" << std::endl
+     << "}" << std::endl;
+}
+
+void
+MultiStageTable::emitDefinitions(std::ostream& os, const std::string& name) const
+{
+  for (size_t s = 0; s < m_stages.size(); s++) {
+    const std::vector<uint32_t>& stage = m_stages[s];
+
+    os << "const " << elementType(maxElement(stage)) << ' '
+       << name << "_stage" << s << "[" << stage.size() << "] = {";
+
+    size_t column = 80;
+    for (size_t i = 0; i < stage.size(); i++) {
+      std::ostringstream item;
+      item << stage[i] << ',';
+      if (column + item.str().size() + 1 > 78) {
+        os << std::endl << "  ";
+        column = 2;
+      }
+      else {
+        os << ' ';
+        column++;
+      }
+      os << item.str();
+      column += item.str().size();
+    }
+    os << std::endl << "};" << std::endl << std::endl;
+  }
+}
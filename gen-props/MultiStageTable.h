@@ -0,0 +1,101 @@
+#ifndef MULTISTAGETABLE_H
+#define MULTISTAGETABLE_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/// @brief A multi-stage ("trie") lookup table over the Unicode code space.
+///
+/// The per-code-point values are cut into blocks of 2^leafBits entries,
+/// identical blocks are stored once, and an index array maps each block
+/// of the code space to its stored copy. For a three-stage table the
+/// index array is itself cut into blocks of 2^indexBits entries and
+/// deduplicated the same way. A lookup is then two or three dependent
+/// array loads and no branches.
+///
+/// Stages are numbered from the top: stages()[0] is indexed by the high
+/// bits of the code point and the last stage holds the values.
+class MultiStageTable {
+    std::vector<std::vector<uint32_t> > m_stages;
+    std::vector<unsigned> m_bits;  // block bits of stages 1..n, top first
+
+  public:
+    /// @brief Build a table over @p values, which holds one value per
+    /// code point in [0, 0x10ffff]. @p indexBits of zero builds a
+    /// two-stage table.
+    MultiStageTable(const std::vector<uint32_t>& values,
+                    unsigned leafBits, unsigned indexBits = 0);
+
+    /// @brief Try the plausible block sizes and return the smallest
+    /// table with @p nStages (2 or 3) stages.
+    static MultiStageTable smallest(const std::vector<uint32_t>& values,
+                                    unsigned nStages);
+
+    const std::vector<std::vector<uint32_t> >& stages() const
+    { return m_stages; }
+
+    /// @brief Value stored for @p cp. Used to check the built table.
+    uint32_t lookup(uint32_t cp) const;
+
+    /// @brief Total size in bytes of the emitted arrays.
+    size_t byteSize() const;
+
+    /// @brief Describe the shape and size of each stage.
+    void report(std::ostream& os, const std::string& name) const;
+
+    /// @brief Emit extern declarations of the stage arrays, which are
+    /// named @p name_stageN, and an inline lookup function
+    /// @p function(cp) returning @p valueType.
+    void emitDeclarations(std::ostream& os, const std::string& name,
+                          const std::string& function,
+                          const std::string& valueType) const;
+
+    /// @brief Emit the definitions of the stage arrays.
+    void emitDefinitions(std::ostream& os, const std::string& name) const;
+
+    /// @brief Smallest unsigned integer type that can hold @p maxValue.
+    static const char *elementType(uint32_t maxValue);
+    static size_t elementSize(uint32_t maxValue);
+};
+
+#endif // MULTISTAGETABLE_H
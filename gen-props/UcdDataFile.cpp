@@ -0,0 +1,150 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <stdlib.h>
+
+#include "UcdDataFile.h"
+
+using namespace libucd;
+
+static std::string
+trim(const std::string& s)
+{
+  size_t first = s.find_first_not_of(" \t\r");
+  if (first == std::string::npos)
+    return "";
+  size_t last = s.find_last_not_of(" \t\r");
+  return s.substr(first, last - first + 1);
+}
+
+static CodePoint_t
+parseCodePoint(const std::string& s, const std::string& where)
+{
+  char *end;
+  unsigned long cp = strtoul(s.c_str(), &end, 16);
+  if (s.empty() || *end || cp > CODEPOINT_MAX)
+    throw std::runtime_error(where + ": bad code point '" + s + "'");
+  return cp;
+}
+
+// Parse "XXXX" or "XXXX..YYYY"
+static CodePointRange
+parseRange(const std::string& field, const std::string& where)
+{
+  std::string s = trim(field);
+  size_t dots = s.find("..");
+  if (dots == std::string::npos)
+    return CodePointRange(parseCodePoint(s, where));
+
+  return CodePointRange(parseCodePoint(s.substr(0, dots), where),
+                        parseCodePoint(s.substr(dots + 2), where));
+}
+
+// Split a data line into its ';'-separated fields, returning false if
+// there are fewer than two.
+static bool
+splitFields(const std::string& line, std::vector<std::string>& fields)
+{
+  fields.clear();
+  std::istringstream is(line);
+  std::string field;
+  while (std::getline(is, field, ';'))
+    fields.push_back(trim(field));
+  return fields.size() >= 2;
+}
+
+// Return the value a line assigns, or false if the line is for some
+// property other than /select/.
+static bool
+lineValue(const std::vector<std::string>& fields, const std::string& select,
+          std::string& value)
+{
+  if (select.empty()) {
+    value = fields[1];
+    return true;
+  }
+
+  if (fields[1] != select)
+    return false;
+
+  value = (fields.size() > 2) ? fields[2] : "Y";
+  return true;
+}
+
+void
+UcdDataFile::read(const std::string& path, const std::string& select)
+{
+  std::ifstream is(path.c_str());
+  if (!is)
+    throw std::runtime_error(path + ": cannot open");
+
+  static const std::string MISSING = "# @missing:";
+
+  std::string line;
+  std::vector<std::string> fields;
+  std::string value;
+  unsigned lineNo = 0;
+
+  while (std::getline(is, line)) {
+    lineNo++;
+    std::ostringstream where;
+    where << path << ':' << lineNo;
+
+    if (line.compare(0, MISSING.size(), MISSING) == 0) {
+      if (!splitFields(line.substr(MISSING.size()), fields))
+        throw std::runtime_error(where.str() + ": malformed @missing line");
+      if (lineValue(fields, select, value))
+        missing.push_back(Assignment(parseRange(fields[0], where.str()),
+                                     value));
+      continue;
+    }
+
+    line = line.substr(0, line.find('#'));
+    if (trim(line).empty())
+      continue;
+
+    if (!splitFields(line, fields))
+      throw std::runtime_error(where.str() + ": malformed data line");
+
+    if (lineValue(fields, select, value))
+      values[value].insert(parseRange(fields[0], where.str()));
+  }
+}
@@ -0,0 +1,86 @@
+#ifndef UCDDATAFILE_H
+#define UCDDATAFILE_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "CodePointSet.h"
+
+/// @brief The contents of one of the semicolon-delimited UCD data files,
+/// such as DerivedGeneralCategory.txt or Scripts.txt.
+///
+/// Each data line has the form
+///
+///     XXXX..YYYY ; Value # comment
+///
+/// and assigns @em Value to the given code points. For enumerated
+/// property files the second field is a property value; for binary
+/// property files (e.g. DerivedCoreProperties.txt) it names the
+/// property.
+///
+/// Files that mix several properties, such as
+/// DerivedNormalizationProps.txt, name the property in the second field
+/// and give its value in the third:
+///
+///     0340..0341 ; NFC_QC; N # comment
+///
+/// Such a file is read with a @em select property name: only the lines
+/// for that property are used, and the value is taken from the third
+/// field, or is "Y" for a binary property line that has none.
+struct UcdDataFile {
+  typedef std::pair<libucd::CodePointRange, std::string> Assignment;
+
+  /// @brief Code points having each value named in the file.
+  std::map<std::string, libucd::CodePointSet> values;
+
+  /// @brief Default values given by "# @missing:" lines, in file order.
+  /// Later lines take precedence over earlier ones.
+  std::vector<Assignment> missing;
+
+  /// @brief Read and parse @p path, keeping only the lines for property
+  /// @p select if it is non-empty. Throws std::runtime_error if the file
+  /// cannot be read or is malformed.
+  void read(const std::string& path, const std::string& select = "");
+};
+
+#endif // UCDDATAFILE_H
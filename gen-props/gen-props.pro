@@ -3,4 +3,18 @@ CONFIG += console c++11
 CONFIG -= app_bundle
 CONFIG -= qt
 
-SOURCES += main.cpp
+INCLUDEPATH += ../lang/c++/libucd
+LIBS += -L$$OUT_PWD/../lang/c++/libucd -llibucd
+PRE_TARGETDEPS += $$OUT_PWD/../lang/c++/libucd/liblibucd.a
+
+SOURCES += main.cpp \
+    AliasHash.cpp \
+    GeneratedFiles.cpp \
+    MultiStageTable.cpp \
+    UcdDataFile.cpp
+
+HEADERS += \
+    AliasHash.h \
+    GeneratedFiles.h \
+    MultiStageTable.h \
+    UcdDataFile.h
@@ -1,9 +1,1123 @@
+#include <algorithm>
+#include <ctype.h>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "AliasFile.h"
+#include "AliasHash.h"
+#include "GeneratedFiles.h"
+#include "MultiStageTable.h"
+#include "UcdDataFile.h"
 
 using namespace std;
+using namespace libucd;
 
-int main(int argc, char *argv[])
+static void
+usage(ostream& os)
+{
+  os << "Usage: gen-props COMMAND [options]" << endl
+     << endl
+     << "Commands:" << endl
+     << "  table --name PROP -o BASE [options] FILE..." << endl
+     << "      Emit a multi-stage lookup table for the enumerated property" << endl
+     << "      PROP from UCD data FILEs (e.g. DerivedGeneralCategory.txt)." << endl
+     << "      Writes BASE.h and BASE.cpp." << endl
+     << "        --stages N          2 or 3 lookup stages (default 2)" << endl
+     << "        --leaf-bits N       log2 of the value block size" << endl
+     << "        --index-bits N      log2 of the index block size (3 stages)" << endl
+     << "                            Block sizes that are not given are chosen" << endl
+     << "                            to minimize the table size." << endl
+     << "        --default VALUE     value of code points not listed in any" << endl
+     << "                            FILE or @missing line" << endl
+     << "        --select PROP       use only the lines of FILE that give PROP," << endl
+     << "                            for files such as DerivedNormalizationProps.txt" << endl
+     << "                            that describe several properties" << endl
+     << "        --numeric           values are unsigned integers (e.g." << endl
+     << "                            Canonical_Combining_Class); store them as is" << endl
+     << "                            instead of emitting an enumeration" << endl
+     << "        --namespace NS      namespace of the generated code (default ucd)" << endl
+     << endl
+     << "  identifier -o BASE [options] FILE..." << endl
+     << "      Emit scan_identifier(), which finds the end of an identifier in" << endl
+     << "      UTF-8 text, and the tables behind it, from UCD data FILEs that" << endl
+     << "      list the identifier properties (DerivedCoreProperties.txt)." << endl
+     << "      Writes BASE.h and BASE.cpp." << endl
+     << "        --name NAME         name of the scanner and its tables, e.g." << endl
+     << "                            scan_NAME() (default: the file name of BASE)" << endl
+     << "        --start PROP        property of identifier start characters" << endl
+     << "                            (default XID_Start)" << endl
+     << "        --continue PROP     property of identifier characters" << endl
+     << "                            (default XID_Continue)" << endl
+     << "        --extra-start CHARS characters, in UTF-8, that may also start" << endl
+     << "                            and continue an identifier (e.g. '_' for" << endl
+     << "                            C-like languages; default none). ASCII" << endl
+     << "                            other than [0-9A-Z_a-z] turns off the SIMD" << endl
+     << "                            skipping of ASCII identifier runs" << endl
+     << "        --stages N          2 or 3 lookup stages (default 3)" << endl
+     << "        --namespace NS      namespace of the generated code (default ucd)" << endl
+     << endl
+     << "  lexer-class -o BASE [options] FIELD..." << endl
+     << "      Emit a lookup table giving, for each code point, one value that" << endl
+     << "      packs several properties as bit fields, so that a tokenizer" << endl
+     << "      needs a single lookup per character. Fields are packed from" << endl
+     << "      bit 0 up in the order given, and are" << endl
+     << "        --enum PROP=FILE[,FILE...]" << endl
+     << "                            enumerated property PROP, from UCD data" << endl
+     << "                            FILEs (e.g. Script=Scripts.txt), stored as" << endl
+     << "                            the number of its value" << endl
+     << "        --flag PROP=FILE[,FILE...]" << endl
+     << "                            binary property PROP, from UCD data FILEs" << endl
+     << "                            (e.g. XID_Start=DerivedCoreProperties.txt)," << endl
+     << "                            stored as one bit" << endl
+     << "      Writes BASE.h and BASE.cpp." << endl
+     << "        --name NAME         name of the table (default lexer_class)" << endl
+     << "        --default PROP=VALUE" << endl
+     << "                            value of code points that the files of" << endl
+     << "                            --enum field PROP do not cover" << endl
+     << "        --stages N          2 or 3 lookup stages (default 2)" << endl
+     << "        --namespace NS      namespace of the generated code (default ucd)" << endl
+     << endl
+     << "  casefold -o BASE [options] CASE_FOLDING" << endl
+     << "      Emit the simple case folding of CASE_FOLDING (CaseFolding.txt)" << endl
+     << "      as a table of deltas, for libucd's caseless UTF-8 routines." << endl
+     << "      Writes BASE.h and BASE.cpp." << endl
+     << "        --name NAME         name of the table (default casefold)" << endl
+     << "        --stages N          2 or 3 lookup stages (default 3)" << endl
+     << "        --namespace NS      namespace of the generated code (default ucd)" << endl
+     << endl
+     << "  aliases -o BASE [options] PROPERTY_ALIASES VALUE_ALIASES" << endl
+     << "      Emit functions that resolve property and property value" << endl
+     << "      aliases, with UAX44-LM3 loose matching, through a minimal" << endl
+     << "      perfect hash. PROPERTY_ALIASES and VALUE_ALIASES are" << endl
+     << "      PropertyAliases.txt and PropertyValueAliases.txt." << endl
+     << "      Writes BASE.h and BASE.cpp." << endl
+     << "        --namespace NS      namespace of the generated code (default ucd)" << endl;
+}
+
+// Fetch the argument of option argv[i], advancing i past it.
+static string
+optionArg(int argc, char *argv[], int& i)
+{
+  if (i + 1 >= argc)
+    throw runtime_error(string("missing argument to ") + argv[i]);
+  return argv[++i];
+}
+
+static unsigned
+optionNumber(int argc, char *argv[], int& i)
+{
+  string opt = argv[i];
+  string arg = optionArg(argc, argv, i);
+  char *end;
+  unsigned long n = strtoul(arg.c_str(), &end, 10);
+  if (arg.empty() || *end)
+    throw runtime_error("bad number '" + arg + "' for " + opt);
+  return n;
+}
+
+// Number the values of an enumerated property in name order, so that the
+// enumerators are stable as long as the set of values is, and return the
+// value of each code point: the one /data/ gives it, else that of the
+// last @missing line that covers it, else /defaultValue/. If /numeric/,
+// each value is its own number. /what/ prefixes error messages.
+static vector<uint32_t>
+propertyValues(const UcdDataFile& data, const string& defaultValue,
+               bool numeric, const string& what,
+               map<string, uint32_t>& valueIds, uint32_t& maxValue)
 {
-  cout << "Hello World!" << endl;
+  set<string> valueNames;
+  for (auto it = data.values.begin(); it != data.values.end(); it++)
+    valueNames.insert(it->first);
+  for (size_t i = 0; i < data.missing.size(); i++)
+    valueNames.insert(data.missing[i].second);
+  if (!defaultValue.empty())
+    valueNames.insert(defaultValue);
+
+  valueIds.clear();
+  maxValue = 0;
+  for (auto it = valueNames.begin(); it != valueNames.end(); it++) {
+    uint32_t id = uint32_t(valueIds.size());
+    if (numeric) {
+      char *end;
+      id = strtoul(it->c_str(), &end, 10);
+      if (it->empty() || *end)
+        throw runtime_error(what + ": value '" + *it + "' is not a number");
+    }
+    valueIds.insert({ *it, id });
+    maxValue = max(maxValue, id);
+  }
+
+  const uint32_t UNASSIGNED = UINT32_MAX;
+  vector<uint32_t> values(CODEPOINT_MAX + 1,
+                          defaultValue.empty() ? UNASSIGNED : valueIds[defaultValue]);
+
+  for (size_t i = 0; i < data.missing.size(); i++) {
+    const CodePointRange& r = data.missing[i].first;
+    fill(values.begin() + r.min(), values.begin() + r.max() + 1,
+         valueIds[data.missing[i].second]);
+  }
+  for (auto it = data.values.begin(); it != data.values.end(); it++) {
+    for (auto r = it->second.begin(); r != it->second.end(); r++)
+      fill(values.begin() + r->min(), values.begin() + r->max() + 1,
+           valueIds[it->first]);
+  }
+
+  if (find(values.begin(), values.end(), UNASSIGNED) != values.end())
+    throw runtime_error(what + ": some code points have no value; use --default");
+
+  return values;
+}
+
+// Emit the enumeration of the values of property /name/ to /h/, and the
+// array of their names to /h/ and /s/.
+static void
+emitValueEnum(ostream& h, ostream& s, const string& name,
+              const string& valueType, const map<string, uint32_t>& valueIds)
+{
+  string id = GeneratedFiles::identifier(name);
+
+  h << "enum class " << id << " : " << valueType << " {" << endl;
+  for (auto it = valueIds.begin(); it != valueIds.end(); it++)
+    h << "  " << GeneratedFiles::identifier(it->first)
+      << " = " << it->second << "," << endl;
+  h << "};" << endl << endl
+    << "/// @brief " << name << " value names, indexed by value." << endl
+    << "extern const char *const " << id << "_names["
+    << valueIds.size() << "];" << endl << endl;
+
+  s << "const char *const " << id << "_names["
+    << valueIds.size() << "] = {" << endl;
+  for (auto it = valueIds.begin(); it != valueIds.end(); it++)
+    s << "  \"" << it->first << "\"," << endl;
+  s << "};" << endl << endl;
+}
+
+static int
+cmdTable(int argc, char *argv[])
+{
+  string name;
+  string base;
+  string defaultValue;
+  string select;
+  string nameSpace = "ucd";
+  bool numeric = false;
+  unsigned nStages = 2;
+  unsigned leafBits = 0;
+  unsigned indexBits = 0;
+  vector<string> inputs;
+
+  for (int i = 0; i < argc; i++) {
+    string arg = argv[i];
+    if (arg == "--name")
+      name = optionArg(argc, argv, i);
+    else if (arg == "-o")
+      base = optionArg(argc, argv, i);
+    else if (arg == "--default")
+      defaultValue = optionArg(argc, argv, i);
+    else if (arg == "--namespace")
+      nameSpace = optionArg(argc, argv, i);
+    else if (arg == "--select")
+      select = optionArg(argc, argv, i);
+    else if (arg == "--numeric")
+      numeric = true;
+    else if (arg == "--stages")
+      nStages = optionNumber(argc, argv, i);
+    else if (arg == "--leaf-bits")
+      leafBits = optionNumber(argc, argv, i);
+    else if (arg == "--index-bits")
+      indexBits = optionNumber(argc, argv, i);
+    else if (arg.size() > 1 && arg[0] == '-')
+      throw runtime_error("unknown option " + arg);
+    else
+      inputs.push_back(arg);
+  }
+
+  if (name.empty() || base.empty() || inputs.empty())
+    throw runtime_error("table: --name, -o and at least one FILE are required");
+  if (nStages != 2 && nStages != 3)
+    throw runtime_error("table: --stages must be 2 or 3");
+
+  UcdDataFile data;
+  for (size_t i = 0; i < inputs.size(); i++)
+    data.read(inputs[i], select);
+
+  map<string, uint32_t> valueIds;
+  uint32_t maxValue;
+  vector<uint32_t> values =
+    propertyValues(data, defaultValue, numeric, "table", valueIds, maxValue);
+
+  MultiStageTable table =
+    (leafBits == 0)
+    ? MultiStageTable::smallest(values, nStages)
+    : MultiStageTable(values, leafBits, (nStages == 3) ? indexBits : 0);
+
+  for (CodePoint_t cp = 0; cp <= CODEPOINT_MAX; cp++) {
+    if (table.lookup(cp) != values[cp])
+      throw logic_error("table: lookup does not reproduce input");
+  }
+
+  string id = GeneratedFiles::identifier(name);
+  string valueType = MultiStageTable::elementType(maxValue);
+
+  GeneratedFiles out(base, nameSpace,
+                     "Multi-stage lookup table for the " + name + " property.",
+                     { "<stdint.h>", "\"CodePoint.h\"" });
+
+  if (numeric) {
+    table.emitDeclarations(out.header(), id, "lookup_" + id, valueType);
+    out.header() << endl;
+  }
+  else {
+    emitValueEnum(out.header(), out.source(), name, valueType, valueIds);
+    table.emitDeclarations(out.header(), id, "lookup_" + id, id);
+    out.header() << endl;
+  }
+  table.emitDefinitions(out.source(), id);
+
+  out.close();
+
+  table.report(cerr, name);
   return 0;
 }
+
+// Code of scan_NAME(), with NAME written as @NAME@ and its upper-case
+// form as @UNAME@. ASCII is classified through NAME_ascii; when the
+// ASCII identifier characters are exactly [0-9A-Z_a-z], runs of them
+// are also skipped 16 bytes at a time.
+// Anything else is decoded by the strict UTF-8 automaton of Utf8Dfa.h
+// and looked up in the table, so that an overlong, surrogate or
+// otherwise ill-formed sequence ends the identifier.
+static const char *const scanIdentifierSource = R"(const char *
+scan_@NAME@(const char *p, const char *end)
+{
+  const char *s = p;
+  unsigned want = @UNAME@_START;
+
+  while (s < end) {
+    unsigned char b = *s;
+    if (b < 0x80) {
+      if (!(@NAME@_ascii[b] & want))
+        break;
+      s++;
+      want = @UNAME@_CONTINUE;
+#ifdef IDENTIFIER_HAVE_SSE2
+      // Skip the rest of a run of [0-9A-Z_a-z]. Bytes are compared as
+      // signed, so non-ASCII bytes fall below every range.
+      while ((end - s) >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *) s);
+        __m128i folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        __m128i letter =
+          _mm_and_si128(_mm_cmpgt_epi8(folded, _mm_set1_epi8('a' - 1)),
+                        _mm_cmplt_epi8(folded, _mm_set1_epi8('z' + 1)));
+        __m128i digit =
+          _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                        _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+        __m128i word =
+          _mm_or_si128(_mm_or_si128(letter, digit),
+                       _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+        uint32_t stop = ~uint32_t(_mm_movemask_epi8(word)) & 0xffff;
+        if (stop) {
+          s += identifier_ctz(stop);
+          break;
+        }
+        s += 16;
+      }
+#endif
+      continue;
+    }
+
+    const char *next = s;
+    libucd::CodePoint_t cp = 0;
+    uint32_t state = libucd::UTF8_DFA_ACCEPT;
+    do
+      state = libucd::utf8_dfa_step(state, cp, *next++);
+    while (state != libucd::UTF8_DFA_ACCEPT &&
+           state != libucd::UTF8_DFA_REJECT && next != end);
+    if (state != libucd::UTF8_DFA_ACCEPT ||
+        !(lookup_@NAME@(cp) & want))
+      break;
+    s = next;
+    want = @UNAME@_CONTINUE;
+  }
+
+  return s;
+}
+)";
+
+static const char *const simdPreamble = R"(#include "Utf8Dfa.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define IDENTIFIER_HAVE_SSE2 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+)";
+
+static const char *const ctzSource = R"(#ifdef IDENTIFIER_HAVE_SSE2
+static inline unsigned
+identifier_ctz(uint32_t mask)
+{
+#if defined(_MSC_VER)
+  unsigned long ndx;
+  _BitScanForward(&ndx, mask);
+  return ndx;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+)";
+
+// Replace every @NAME@ in /text/ by /name/ and every @UNAME@ by its
+// upper-case form.
+static string
+substituteName(const char *text, const string& name)
+{
+  string upper;
+  for (size_t i = 0; i < name.size(); i++)
+    upper += toupper((unsigned char) name[i]);
+
+  string out = text;
+  const string keys[2] = { "@NAME@", "@UNAME@" };
+  const string values[2] = { name, upper };
+  for (int k = 0; k < 2; k++) {
+    for (size_t at = out.find(keys[k]); at != string::npos;
+         at = out.find(keys[k], at + values[k].size()))
+      out.replace(at, keys[k].size(), values[k]);
+  }
+  return out;
+}
+
+static int
+cmdIdentifier(int argc, char *argv[])
+{
+  string base;
+  string name;
+  string nameSpace = "ucd";
+  string startProperty = "XID_Start";
+  string continueProperty = "XID_Continue";
+  string extraStart;
+  unsigned nStages = 3;
+  vector<string> inputs;
+
+  for (int i = 0; i < argc; i++) {
+    string arg = argv[i];
+    if (arg == "-o")
+      base = optionArg(argc, argv, i);
+    else if (arg == "--name")
+      name = optionArg(argc, argv, i);
+    else if (arg == "--namespace")
+      nameSpace = optionArg(argc, argv, i);
+    else if (arg == "--start")
+      startProperty = optionArg(argc, argv, i);
+    else if (arg == "--continue")
+      continueProperty = optionArg(argc, argv, i);
+    else if (arg == "--extra-start")
+      extraStart = optionArg(argc, argv, i);
+    else if (arg == "--stages")
+      nStages = optionNumber(argc, argv, i);
+    else if (arg.size() > 1 && arg[0] == '-')
+      throw runtime_error("unknown option " + arg);
+    else
+      inputs.push_back(arg);
+  }
+
+  if (base.empty() || inputs.empty())
+    throw runtime_error("identifier: -o and at least one FILE are required");
+  if (nStages != 2 && nStages != 3)
+    throw runtime_error("identifier: --stages must be 2 or 3");
+
+  vector<CodePoint_t> extra(extraStart.size());
+  Utf8DecodeStatus status;
+  extra.resize(utf8_decode_checked(extraStart.data(), extraStart.size(),
+                                   extra.data(), UTF8_STOP, &status));
+  if (status.error != UTF8_OK)
+    throw runtime_error(string("identifier: --extra-start: ") +
+                        utf8_error_name(status.error));
+
+  UcdDataFile data;
+  for (size_t i = 0; i < inputs.size(); i++)
+    data.read(inputs[i], "");
+
+  auto start = data.values.find(startProperty);
+  auto cont = data.values.find(continueProperty);
+  if (start == data.values.end() || cont == data.values.end())
+    throw runtime_error("identifier: no code points have " +
+                        ((start == data.values.end()) ? startProperty
+                                                      : continueProperty));
+
+  // Bit 0 is NAME_START and bit 1 NAME_CONTINUE. The --extra-start
+  // characters widen the start set, as the profiles of UAX #31 do for
+  // e.g. '_' or '$', and are added to the continue set too so that they
+  // may appear anywhere in an identifier.
+  const uint32_t START = 1, CONTINUE = 2;
+  vector<uint32_t> values(CODEPOINT_MAX + 1, 0);
+  for (auto r = start->second.begin(); r != start->second.end(); r++)
+    for (CodePoint_t cp = r->min(); cp <= r->max(); cp++)
+      values[cp] |= START;
+  for (auto r = cont->second.begin(); r != cont->second.end(); r++)
+    for (CodePoint_t cp = r->min(); cp <= r->max(); cp++)
+      values[cp] |= CONTINUE;
+  ostringstream extraNames;
+  for (size_t i = 0; i < extra.size(); i++) {
+    values[extra[i]] |= START | CONTINUE;
+    extraNames << (i ? ", " : ", or ") << "U+" << hex << uppercase
+               << setw(4) << setfill('0') << extra[i];
+  }
+
+  bool wordRuns = true;
+  for (CodePoint_t cp = 0; cp < 0x80; cp++) {
+    bool word = isalnum(cp) || cp == '_';
+    if (word != ((values[cp] & CONTINUE) != 0))
+      wordRuns = false;
+  }
+
+  MultiStageTable table = MultiStageTable::smallest(values, nStages);
+  for (CodePoint_t cp = 0; cp <= CODEPOINT_MAX; cp++) {
+    if (table.lookup(cp) != values[cp])
+      throw logic_error("identifier: lookup does not reproduce input");
+  }
+
+  string id = GeneratedFiles::identifier(
+    name.empty() ? GeneratedFiles::baseName(base) : name);
+  string uid = substituteName("@UNAME@", id);
+
+  GeneratedFiles out(base, nameSpace,
+                     "Identifier scanning by " + startProperty + " and " +
+                     continueProperty + ".",
+                     { "<stdint.h>", "\"CodePoint.h\"" },
+                     wordRuns ? simdPreamble : "#include \"Utf8Dfa.h\"\n");
+
+  ostream& h = out.header();
+  h << "/// @brief Bits of the identifier class of a code point." << endl
+    << "enum : uint8_t {" << endl
+    << "  " << uid << "_START = 1,     // " << startProperty << extraNames.str()
+    << endl
+    << "  " << uid << "_CONTINUE = 2,  // " << continueProperty << endl
+    << "};" << endl << endl
+    << "/// @brief Identifier classes of the ASCII characters." << endl
+    << "extern const uint8_t " << id << "_ascii[128];" << endl << endl;
+  table.emitDeclarations(h, id, "lookup_" + id, "uint8_t");
+  h << endl
+    << "/// @brief If [p, end) starts with an identifier, a start character"
+    << endl
+    << "/// followed by any number of continue characters, return the end of"
+    << endl
+    << "/// it; otherwise return @p p. Ill-formed UTF-8 ends the identifier."
+    << endl
+    << "const char *scan_" << id << "(const char *p, const char *end);" << endl
+    << endl;
+
+  ostream& s = out.source();
+  s << "const uint8_t " << id << "_ascii[128] = {";
+  for (CodePoint_t cp = 0; cp < 0x80; cp++)
+    s << ((cp % 16) ? " " : "\n  ") << values[cp] << ",";
+  s << endl << "};" << endl << endl;
+  table.emitDefinitions(s, id);
+  if (wordRuns)
+    s << ctzSource;
+  s << substituteName(scanIdentifierSource, id) << endl;
+
+  out.close();
+
+  table.report(cerr, id);
+  if (!wordRuns)
+    cerr << "identifier: ASCII identifier characters are not [0-9A-Z_a-z];"
+         << " no SIMD run skipping" << endl;
+  return 0;
+}
+
+// One field of a lexer class value: the number of the value of an
+// enumerated property, or one bit for a binary property.
+struct LexerField {
+  string property;
+  bool binary;
+  vector<string> files;
+  map<string, uint32_t> valueIds;  // enumerated properties only
+  unsigned shift;
+  unsigned bits;
+};
+
+// Split an option argument of the form NAME=VALUE.
+static pair<string, string>
+splitAssignment(const string& arg, const string& opt)
+{
+  size_t eq = arg.find('=');
+  if (eq == string::npos || eq == 0 || eq + 1 == arg.size())
+    throw runtime_error("bad argument '" + arg + "' for " + opt +
+                        "; expected NAME=VALUE");
+  return { arg.substr(0, eq), arg.substr(eq + 1) };
+}
+
+static vector<string>
+splitList(const string& list)
+{
+  vector<string> items;
+  size_t start = 0;
+  for (;;) {
+    size_t comma = list.find(',', start);
+    items.push_back(list.substr(start, comma - start));
+    if (comma == string::npos)
+      return items;
+    start = comma + 1;
+  }
+}
+
+static string
+hexNumber(uint32_t n)
+{
+  ostringstream os;
+  os << "0x" << hex << n;
+  return os.str();
+}
+
+static int
+cmdLexerClass(int argc, char *argv[])
+{
+  string base;
+  string name = "lexer_class";
+  string nameSpace = "ucd";
+  unsigned nStages = 2;
+  vector<LexerField> fields;
+  map<string, string> defaults;
+
+  for (int i = 0; i < argc; i++) {
+    string arg = argv[i];
+    if (arg == "-o")
+      base = optionArg(argc, argv, i);
+    else if (arg == "--name")
+      name = optionArg(argc, argv, i);
+    else if (arg == "--namespace")
+      nameSpace = optionArg(argc, argv, i);
+    else if (arg == "--stages")
+      nStages = optionNumber(argc, argv, i);
+    else if (arg == "--enum" || arg == "--flag") {
+      pair<string, string> a = splitAssignment(optionArg(argc, argv, i), arg);
+      LexerField f;
+      f.property = a.first;
+      f.binary = (arg == "--flag");
+      f.files = splitList(a.second);
+      f.shift = f.bits = 0;
+      fields.push_back(f);
+    }
+    else if (arg == "--default") {
+      pair<string, string> a = splitAssignment(optionArg(argc, argv, i), arg);
+      defaults[a.first] = a.second;
+    }
+    else
+      throw runtime_error("unknown option " + arg);
+  }
+
+  if (base.empty() || fields.empty())
+    throw runtime_error("lexer-class: -o and at least one --enum or --flag are required");
+  if (nStages != 2 && nStages != 3)
+    throw runtime_error("lexer-class: --stages must be 2 or 3");
+
+  set<string> seen;
+  for (size_t k = 0; k < fields.size(); k++) {
+    if (!seen.insert(fields[k].property).second)
+      throw runtime_error("lexer-class: " + fields[k].property +
+                          " is given more than once");
+  }
+  for (auto it = defaults.begin(); it != defaults.end(); it++) {
+    bool found = false;
+    for (size_t k = 0; k < fields.size(); k++)
+      found |= (!fields[k].binary && fields[k].property == it->first);
+    if (!found)
+      throw runtime_error("lexer-class: --default for " + it->first +
+                          ", which is not an --enum field");
+  }
+
+  // Fields are packed from bit 0 up in the order given. Binary property
+  // files usually describe several properties, so each is read once.
+  vector<uint32_t> values(CODEPOINT_MAX + 1, 0);
+  map<string, UcdDataFile> binaryFiles;
+  unsigned shift = 0;
+
+  for (size_t k = 0; k < fields.size(); k++) {
+    LexerField& f = fields[k];
+    f.shift = shift;
+    if (shift == 32)
+      throw runtime_error("lexer-class: the fields need more than 32 bits");
+
+    if (f.binary) {
+      f.bits = 1;
+      bool listed = false;
+      for (size_t i = 0; i < f.files.size(); i++) {
+        auto file = binaryFiles.find(f.files[i]);
+        if (file == binaryFiles.end()) {
+          file = binaryFiles.insert({ f.files[i], UcdDataFile() }).first;
+          file->second.read(f.files[i], "");
+        }
+
+        auto cps = file->second.values.find(f.property);
+        if (cps == file->second.values.end())
+          continue;
+        listed = true;
+        for (auto r = cps->second.begin(); r != cps->second.end(); r++)
+          for (CodePoint_t cp = r->min(); cp <= r->max(); cp++)
+            values[cp] |= uint32_t(1) << shift;
+      }
+
+      if (!listed)
+        throw runtime_error("lexer-class: no code points have " + f.property);
+    }
+    else {
+      UcdDataFile data;
+      for (size_t i = 0; i < f.files.size(); i++)
+        data.read(f.files[i], "");
+
+      uint32_t maxValue;
+      vector<uint32_t> v = propertyValues(data, defaults[f.property], false,
+                                          "lexer-class: " + f.property,
+                                          f.valueIds, maxValue);
+      f.bits = 1;
+      while (maxValue >> f.bits)
+        f.bits++;
+
+      if (shift + f.bits <= 32) {
+        for (CodePoint_t cp = 0; cp <= CODEPOINT_MAX; cp++)
+          values[cp] |= v[cp] << shift;
+      }
+    }
+
+    shift += f.bits;
+    if (shift > 32)
+      throw runtime_error("lexer-class: the fields need more than 32 bits");
+  }
+
+  MultiStageTable table = MultiStageTable::smallest(values, nStages);
+  for (CodePoint_t cp = 0; cp <= CODEPOINT_MAX; cp++) {
+    if (table.lookup(cp) != values[cp])
+      throw logic_error("lexer-class: lookup does not reproduce input");
+  }
+
+  // The value type is chosen for the layout, not for the values that
+  // happen to occur, so that it only changes when the layout does.
+  string id = GeneratedFiles::identifier(name);
+  uint32_t allBits = (shift == 32) ? UINT32_MAX : ((uint32_t(1) << shift) - 1);
+  string valueType = MultiStageTable::elementType(allBits);
+
+  string propertyList;
+  for (size_t k = 0; k < fields.size(); k++)
+    propertyList += (k ? ", " : "") + fields[k].property;
+
+  GeneratedFiles out(base, nameSpace,
+                     "Lexer classes packing " + propertyList + ".",
+                     { "<stdint.h>", "\"CodePoint.h\"" });
+
+  ostream& h = out.header();
+  ostream& s = out.source();
+
+  h << "/// @brief The fields of a value of lookup_" << id << "(), from bit 0 up:"
+    << endl;
+  for (size_t k = 0; k < fields.size(); k++) {
+    const LexerField& f = fields[k];
+    h << "///   - " << f.property << ": ";
+    if (f.bits == 1)
+      h << "bit " << f.shift << endl;
+    else
+      h << "bits " << f.shift << "-" << (f.shift + f.bits - 1) << endl;
+  }
+  h << "namespace " << id << " {" << endl << endl;
+  s << "namespace " << id << " {" << endl << endl;
+
+  for (size_t k = 0; k < fields.size(); k++) {
+    const LexerField& f = fields[k];
+    if (!f.binary)
+      emitValueEnum(h, s, f.property, MultiStageTable::elementType(
+                      (uint32_t(1) << f.bits) - 1), f.valueIds);
+  }
+
+  h << "/// @brief Masks of the binary properties, and the position and"
+    << endl
+    << "/// width of the enumerated ones." << endl
+    << "enum : " << valueType << " {" << endl;
+  for (size_t k = 0; k < fields.size(); k++) {
+    const LexerField& f = fields[k];
+    string fid = GeneratedFiles::identifier(f.property);
+    uint32_t mask = ((f.bits == 32) ? UINT32_MAX : ((uint32_t(1) << f.bits) - 1))
+      << f.shift;
+    if (f.binary) {
+      h << "  " << fid << " = " << hexNumber(mask) << "," << endl;
+    }
+    else {
+      h << "  " << fid << "_shift = " << f.shift << "," << endl
+        << "  " << fid << "_mask = " << hexNumber(mask) << "," << endl;
+    }
+  }
+  h << "};" << endl << endl;
+
+  for (size_t k = 0; k < fields.size(); k++) {
+    const LexerField& f = fields[k];
+    if (f.binary)
+      continue;
+
+    string fid = GeneratedFiles::identifier(f.property);
+    h << "/// @brief The " << f.property << " field of @p c." << endl
+      << "inline " << fid << endl
+      << fid << "_of(" << valueType << " c)" << endl
+      << "{" << endl
+      << "  return " << fid << "((c & " << fid << "_mask) >> "
+      << fid << "_shift);" << endl
+      << "}" << endl << endl;
+  }
+
+  h << "} // namespace " << id << endl << endl;
+  s << "} // namespace " << id << endl << endl;
+
+  table.emitDeclarations(h, id, "lookup_" + id, valueType);
+  h << endl;
+  table.emitDefinitions(s, id);
+
+  out.close();
+
+  table.report(cerr, name);
+  return 0;
+}
+
+static int
+cmdCaseFold(int argc, char *argv[])
+{
+  string base;
+  string name = "casefold";
+  string nameSpace = "ucd";
+  unsigned nStages = 3;
+  vector<string> inputs;
+
+  for (int i = 0; i < argc; i++) {
+    string arg = argv[i];
+    if (arg == "-o")
+      base = optionArg(argc, argv, i);
+    else if (arg == "--name")
+      name = optionArg(argc, argv, i);
+    else if (arg == "--namespace")
+      nameSpace = optionArg(argc, argv, i);
+    else if (arg == "--stages")
+      nStages = optionNumber(argc, argv, i);
+    else if (arg.size() > 1 && arg[0] == '-')
+      throw runtime_error("unknown option " + arg);
+    else
+      inputs.push_back(arg);
+  }
+
+  if (base.empty() || inputs.size() != 1)
+    throw runtime_error("casefold: -o and CaseFolding.txt are required");
+  if (nStages != 2 && nStages != 3)
+    throw runtime_error("casefold: --stages must be 2 or 3");
+
+  // Simple case folding is given by the lines of status C (common to
+  // simple and full folding) and S (simple only). The mapping field is
+  // where the value of a property would be.
+  UcdDataFile data;
+  data.read(inputs[0], "C");
+  data.read(inputs[0], "S");
+  if (data.values.empty())
+    throw runtime_error("casefold: " + inputs[0] + " has no C or S lines");
+
+  // Most folds move a code point by the same distance as its neighbours
+  // do (+32 for Latin, +1 for the alternating pairs, +80 for Cyrillic),
+  // so the table stores an index into the few distinct deltas, and its
+  // blocks deduplicate well. Delta 0 is index 0.
+  vector<int32_t> deltas(1, 0);
+  map<int32_t, uint32_t> deltaIds;
+  deltaIds.insert({ 0, 0 });
+
+  vector<uint32_t> values(CODEPOINT_MAX + 1, 0);
+  vector<CodePoint_t> folded(CODEPOINT_MAX + 1);
+  for (CodePoint_t cp = 0; cp <= CODEPOINT_MAX; cp++)
+    folded[cp] = cp;
+
+  for (auto it = data.values.begin(); it != data.values.end(); it++) {
+    char *end;
+    unsigned long target = strtoul(it->first.c_str(), &end, 16);
+    if (it->first.empty() || *end || target > CODEPOINT_MAX)
+      throw runtime_error("casefold: bad simple mapping '" + it->first + "'");
+
+    for (auto r = it->second.begin(); r != it->second.end(); r++) {
+      for (CodePoint_t cp = r->min(); cp <= r->max(); cp++) {
+        int32_t delta = int32_t(target) - int32_t(cp);
+        auto id = deltaIds.find(delta);
+        if (id == deltaIds.end()) {
+          id = deltaIds.insert({ delta, uint32_t(deltas.size()) }).first;
+          deltas.push_back(delta);
+        }
+        values[cp] = id->second;
+        folded[cp] = CodePoint_t(target);
+      }
+    }
+  }
+
+  // The ASCII fast paths of libucd fold exactly A-Z, to a-z.
+  for (CodePoint_t cp = 0; cp < 0x80; cp++) {
+    CodePoint_t expect = (cp >= 'A' && cp <= 'Z') ? cp + 0x20 : cp;
+    if (folded[cp] != expect)
+      throw runtime_error("casefold: ASCII folding is not A-Z to a-z");
+  }
+
+  MultiStageTable table = MultiStageTable::smallest(values, nStages);
+  for (CodePoint_t cp = 0; cp <= CODEPOINT_MAX; cp++) {
+    if (cp + deltas[table.lookup(cp)] != folded[cp])
+      throw logic_error("casefold: lookup does not reproduce input");
+  }
+
+  string id = GeneratedFiles::identifier(name);
+  string indexId = id + "_delta";
+
+  GeneratedFiles out(base, nameSpace,
+                     "Simple case folding table " + name + ".",
+                     { "<stdint.h>", "\"CodePoint.h\"" });
+
+  ostream& h = out.header();
+  h << "/// @brief The distinct differences between a code point and its"
+    << endl
+    << "/// simple case folding." << endl
+    << "extern const int32_t " << id << "_deltas[" << deltas.size() << "];"
+    << endl << endl;
+  table.emitDeclarations(h, indexId, "lookup_" + indexId,
+                         MultiStageTable::elementType(deltas.size() - 1));
+  h << endl
+    << "/// @brief The simple case folding (scf) of @p cp, which must not"
+    << endl
+    << "/// exceed libucd::CODEPOINT_MAX. Usable as a libucd::CaseFoldFunction."
+    << endl
+    << "inline libucd::CodePoint_t" << endl
+    << "lookup_" << id << "(libucd::CodePoint_t cp)" << endl
+    << "{" << endl
+    << "  return cp + " << id << "_deltas[lookup_" << indexId << "(cp)];"
+    << endl
+    << "}" << endl << endl;
+
+  ostream& s = out.source();
+  s << "const int32_t " << id << "_deltas[" << deltas.size() << "] = {";
+  for (size_t i = 0; i < deltas.size(); i++)
+    s << ((i % 8) ? " " : "\n  ") << deltas[i] << ",";
+  s << endl << "};" << endl << endl;
+  table.emitDefinitions(s, indexId);
+
+  out.close();
+
+  table.report(cerr, name);
+  cerr << "  " << deltas.size() << " distinct deltas" << endl;
+  return 0;
+}
+
+static int
+cmdAliases(int argc, char *argv[])
+{
+  string base;
+  string nameSpace = "ucd";
+  vector<string> inputs;
+
+  for (int i = 0; i < argc; i++) {
+    string arg = argv[i];
+    if (arg == "-o")
+      base = optionArg(argc, argv, i);
+    else if (arg == "--namespace")
+      nameSpace = optionArg(argc, argv, i);
+    else if (arg.size() > 1 && arg[0] == '-')
+      throw runtime_error("unknown option " + arg);
+    else
+      inputs.push_back(arg);
+  }
+
+  if (base.empty() || inputs.size() != 2)
+    throw runtime_error("aliases: -o and both alias files are required");
+
+  // Properties are numbered in file order. Scope 0 holds the property
+  // aliases and scope p + 1 the value aliases of property p.
+  vector<AliasHash::Alias> aliases;
+  vector<string> shortNames;
+  vector<string> longNames;
+  map<string, uint32_t> propertyIds;  // by loose key
+
+  vector<vector<string> > records = readAliasFile(inputs[0]);
+  for (size_t r = 0; r < records.size(); r++) {
+    const vector<string>& fields = records[r];
+    if (fields.empty())
+      continue;
+
+    uint32_t id = uint32_t(shortNames.size());
+    shortNames.push_back(fields[0]);
+    longNames.push_back(fields.size() > 1 ? fields[1] : fields[0]);
+    for (size_t i = 0; i < fields.size(); i++) {
+      propertyIds.insert({ AliasHash::looseKey(fields[i]), id });
+      aliases.push_back({ 0, fields[i], id });
+    }
+  }
+
+  // Values are numbered in file order within each property, and named
+  // by the first field after the property, as in the UCD XML files.
+  vector<vector<string> > valueNames(shortNames.size());
+  vector<map<string, uint32_t> > valueIds(shortNames.size());
+
+  records = readAliasFile(inputs[1]);
+  for (size_t r = 0; r < records.size(); r++) {
+    const vector<string>& fields = records[r];
+    if (fields.size() < 2)
+      continue;
+
+    auto p = propertyIds.find(AliasHash::looseKey(fields[0]));
+    if (p == propertyIds.end())
+      throw runtime_error(inputs[1] + ": unknown property " + fields[0]);
+    uint32_t property = p->second;
+
+    auto v = valueIds[property].insert({ AliasHash::looseKey(fields[1]),
+                                         uint32_t(valueNames[property].size()) });
+    if (v.second)
+      valueNames[property].push_back(fields[1]);
+    for (size_t i = 1; i < fields.size(); i++)
+      aliases.push_back({ property + 1, fields[i], v.first->second });
+  }
+
+  AliasHash hash(aliases);
+
+  for (size_t i = 0; i < aliases.size(); i++) {
+    if (hash.lookup(aliases[i].scope, aliases[i].name) != int(aliases[i].target))
+      throw logic_error("aliases: lookup does not reproduce input");
+  }
+
+  size_t nProperties = shortNames.size();
+  size_t nValues = 0;
+  for (size_t p = 0; p < nProperties; p++)
+    nValues += valueNames[p].size();
+
+  GeneratedFiles out(base, nameSpace,
+                     "Perfect hash lookup of property and property value aliases.",
+                     { "<stddef.h>", "<stdint.h>", "\"LooseMatch.h\"" });
+
+  ostream& h = out.header();
+  h << "enum class Property : "
+    << MultiStageTable::elementType(uint32_t(nProperties - 1)) << " {" << endl;
+  for (size_t p = 0; p < nProperties; p++)
+    h << "  " << GeneratedFiles::identifier(longNames[p]) << " = " << p << ","
+      << endl;
+  h << "};" << endl << endl
+    << "/// @brief Short property names, indexed by Property." << endl
+    << "extern const char *const property_names[" << nProperties << "];"
+    << endl << endl
+    << "/// @brief Number of values of @p p listed in the value aliases." << endl
+    << "unsigned property_value_count(Property p);" << endl << endl
+    << "/// @brief Name of value @p v of @p p, or nullptr if @p v is not less"
+    << endl
+    << "/// than property_value_count(p)." << endl
+    << "const char *property_value_name(Property p, unsigned v);" << endl << endl
+    << "/// @brief The Property named by any alias that loosely matches"
+    << endl
+    << "/// [name, name + len) (UAX44-LM3), or -1 if there is none. Nothing is"
+    << endl
+    << "/// allocated and @p name need not be NUL-terminated." << endl
+    << "int lookup_property(const char *name, size_t len);" << endl << endl
+    << "/// @brief The value of @p p named by any alias that loosely matches"
+    << endl
+    << "/// [name, name + len), or -1 if there is none." << endl
+    << "int lookup_property_value(Property p, const char *name, size_t len);"
+    << endl << endl;
+
+  ostream& s = out.source();
+  s << "const char *const property_names[" << nProperties << "] = {" << endl;
+  for (size_t p = 0; p < nProperties; p++)
+    s << "  \"" << shortNames[p] << "\"," << endl;
+  s << "};" << endl << endl;
+
+  vector<uint32_t> firstValue;
+  for (size_t p = 0, n = 0; p <= nProperties; p++) {
+    firstValue.push_back(uint32_t(n));
+    if (p < nProperties)
+      n += valueNames[p].size();
+  }
+
+  s << "static const char *const property_value_names[" << max<size_t>(nValues, 1)
+    << "] = {" << endl;
+  for (size_t p = 0; p < nProperties; p++) {
+    for (size_t v = 0; v < valueNames[p].size(); v++)
+      s << "  \"" << valueNames[p][v] << "\"," << endl;
+  }
+  if (nValues == 0)
+    s << "  nullptr," << endl;
+  s << "};" << endl << endl;
+
+  s << "static const " << MultiStageTable::elementType(uint32_t(nValues))
+    << " property_first_value[" << nProperties + 1 << "] = {";
+  for (size_t p = 0; p <= nProperties; p++)
+    s << (p % 12 ? " " : "\n  ") << firstValue[p] << ",";
+  s << endl << "};" << endl << endl;
+
+  hash.emitDefinitions(s, "alias");
+
+  s << "unsigned" << endl
+    << "property_value_count(Property p)" << endl
+    << "{" << endl
+    << "  return property_first_value[unsigned(p) + 1] -" << endl
+    << "    property_first_value[unsigned(p)];" << endl
+    << "}" << endl << endl
+    << "const char *" << endl
+    << "property_value_name(Property p, unsigned v)" << endl
+    << "{" << endl
+    << "  if (v >= property_value_count(p))" << endl
+    << "    return nullptr;" << endl
+    << "  return property_value_names[property_first_value[unsigned(p)] + v];"
+    << endl
+    << "}" << endl << endl
+    << "int" << endl
+    << "lookup_property(const char *name, size_t len)" << endl
+    << "{" << endl
+    << "  return alias_lookup(0, name, len);" << endl
+    << "}" << endl << endl
+    << "int" << endl
+    << "lookup_property_value(Property p, const char *name, size_t len)" << endl
+    << "{" << endl
+    << "  return alias_lookup(unsigned(p) + 1, name, len);" << endl
+    << "}" << endl << endl;
+
+  out.close();
+
+  hash.report(cerr, "aliases");
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc < 2) {
+    usage(cerr);
+    return 1;
+  }
+
+  string cmd = argv[1];
+
+  try {
+    if (cmd == "table")
+      return cmdTable(argc - 2, argv + 2);
+    if (cmd == "identifier")
+      return cmdIdentifier(argc - 2, argv + 2);
+    if (cmd == "lexer-class")
+      return cmdLexerClass(argc - 2, argv + 2);
+    if (cmd == "casefold")
+      return cmdCaseFold(argc - 2, argv + 2);
+    if (cmd == "aliases")
+      return cmdAliases(argc - 2, argv + 2);
+    if (cmd == "--help" || cmd == "-h") {
+      usage(cout);
+      return 0;
+    }
+
+    cerr << "gen-props: unknown command " << cmd << endl;
+    usage(cerr);
+    return 1;
+  }
+  catch (const exception& ex) {
+    cerr << "gen-props: " << ex.what() << endl;
+    return 1;
+  }
+}
@@ -0,0 +1,91 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <fstream>
+#include <stdexcept>
+
+#include "AliasFile.h"
+
+namespace libucd {
+  namespace {
+    std::string
+    trim(const std::string& s)
+    {
+      const char *ws = " \t\r";
+      size_t first = s.find_first_not_of(ws);
+      if (first == std::string::npos)
+        return "";
+      return s.substr(first, s.find_last_not_of(ws) - first + 1);
+    }
+  }
+
+  std::vector<std::vector<std::string> >
+  readAliasFile(const std::string& path)
+  {
+    std::ifstream in(path.c_str());
+    if (!in)
+      throw std::runtime_error(path + ": cannot open");
+
+    std::vector<std::vector<std::string> > records;
+    std::string line;
+    while (std::getline(in, line)) {
+      line = trim(line.substr(0, line.find('#')));
+      if (line.empty())
+        continue;
+
+      std::vector<std::string> fields;
+      size_t start = 0;
+      for (;;) {
+        size_t semi = line.find(';', start);
+        std::string field = trim(line.substr(start, semi - start));
+        if (!field.empty() && field != "n/a")
+          fields.push_back(field);
+        if (semi == std::string::npos)
+          break;
+        start = semi + 1;
+      }
+
+      records.push_back(fields);
+    }
+
+    if (in.bad())
+      throw std::runtime_error(path + ": read error");
+
+    return records;
+  }
+}
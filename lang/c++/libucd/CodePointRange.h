@@ -138,76 +138,75 @@ namespace libucd {
       typedef CodePoint_t value_type;
       typedef CodePoint_t iterator;
 
-      inline CodePoint_t base() const { return m_min; }
-      inline CodePoint_t bound() const { return m_max+1; }
+      constexpr CodePoint_t base() const { return m_min; }
+      constexpr CodePoint_t bound() const { return m_max+1; }
 
-      CodePointRange() {
-        m_min = std::numeric_limits<CodePoint_t>::max();
-        m_max = std::numeric_limits<CodePoint_t>::min();
-      }
+      constexpr CodePointRange()
+        : m_min(std::numeric_limits<CodePoint_t>::max()),
+          m_max(std::numeric_limits<CodePoint_t>::min())
+      { }
 
-      CodePointRange(const CodePoint_t min, const CodePoint_t max)
-      { m_min = min;
-        m_max = max; }
+      constexpr CodePointRange(const CodePoint_t min, const CodePoint_t max)
+        : m_min(min), m_max(max)
+      { }
 
-      CodePointRange(const CodePoint_t value)
-      { m_min = value;
-        m_max = value; }
+      constexpr CodePointRange(const CodePoint_t value)
+        : m_min(value), m_max(value)
+      { }
 
-      CodePointRange(const CodePointRange & other)
-      { m_min = other.m_min;
-        m_max = other.m_max; }
+      constexpr CodePointRange(const CodePointRange & other) = default;
+      CodePointRange& operator = (const CodePointRange & other) = default;
 
-      CodePoint_t min() const { return m_min; }
-      CodePoint_t max() const { return m_max; }
+      constexpr CodePoint_t min() const { return m_min; }
+      constexpr CodePoint_t max() const { return m_max; }
 
-      static CodePointRange closed(const CodePoint_t min, const CodePoint_t max)
+      static constexpr CodePointRange closed(const CodePoint_t min, const CodePoint_t max)
       { return CodePointRange(min, max); }
-      static CodePointRange open(const CodePoint_t base, const CodePoint_t bound)
+      static constexpr CodePointRange open(const CodePoint_t base, const CodePoint_t bound)
       { return CodePointRange(base, bound-1); }
 
-      static CodePointRange ASCII()
+      static constexpr CodePointRange ASCII()
       { return CodePointRange::closed(0, 127); }
 
-      static CodePointRange Unicode()
+      static constexpr CodePointRange Unicode()
       { return CodePointRange::closed(0, 0x10ffff); }
 
-      iterator begin() const {
+      // Everything below is written as single-expression constexpr
+      // functions so that ranges can be built and compared at compile
+      // time under C++11.
+
+      constexpr iterator begin() const {
         return m_min;
       }
-      iterator end() const {
+      constexpr iterator end() const {
         return empty() ? m_min : (m_max + 1);
       }
 
-      size_t size() const { return (m_max - m_min) + 1; }
+      constexpr size_t size() const { return (m_max - m_min) + 1; }
 
-      bool empty() const {
+      constexpr bool empty() const {
         return ((m_min == std::numeric_limits<CodePoint_t>::max()) &&
                 (m_max == std::numeric_limits<CodePoint_t>::min()));
       }
-      bool isSingleton() const { return (size() == 1); }
+      constexpr bool isSingleton() const { return (size() == 1); }
 
-      bool contains(CodePoint_t cp) const
+      constexpr bool contains(CodePoint_t cp) const
       { return !empty() && ((m_min <= cp) && (cp <= m_max)); }
 
       // All ranges, including the empty range, contain the empty range.
-      bool contains(const CodePointRange & r) const
-      { if (r.empty()) return true;
-        if (empty()) return false;
-        return ((m_min <= r.m_min) && (r.m_max <= m_max));
+      constexpr bool contains(const CodePointRange & r) const
+      { return r.empty() ||
+          (!empty() && (m_min <= r.m_min) && (r.m_max <= m_max));
       }
 
       // All ranges abut the empty range
-      bool abuts(const CodePointRange & r) const
-      { if (empty() || r.empty()) return true;
-        if ((m_min > std::numeric_limits<CodePoint_t>::min()) && ((m_min - 1) == r.m_max))
-          return true;
-        if ((m_max < std::numeric_limits<CodePoint_t>::max()) && ((m_max + 1) == r.m_min))
-          return true;
-        return false;
+      constexpr bool abuts(const CodePointRange & r) const
+      { return (empty() || r.empty()) ||
+          ((m_min > std::numeric_limits<CodePoint_t>::min()) && ((m_min - 1) == r.m_max)) ||
+          ((m_max < std::numeric_limits<CodePoint_t>::max()) && ((m_max + 1) == r.m_min));
       }
 
-      bool overlaps(const CodePointRange & r) const
+      constexpr bool overlaps(const CodePointRange & r) const
       // Four cases of interest; the third is easy to get wrong:
       //    |---- r ----|
       //       |---- *this ----|
@@ -222,69 +221,59 @@ namespace libucd {
       //    |-------- r --------|
       { return (contains(r.m_min) || contains(r.m_max)) || r.contains(m_min); }
 
-      bool canMergeWith(const CodePointRange & r) const
+      constexpr bool canMergeWith(const CodePointRange & r) const
       { return abuts(r) || overlaps(r); }
 
       // Union
-      CodePointRange operator |(const CodePointRange& r) const
-      { if (empty()) return r;
-        if (r.empty()) return *this;
-
-        return CodePointRange(std::min(m_min, r.m_min),
-                              std::max(m_max, r.m_max));
+      constexpr CodePointRange operator |(const CodePointRange& r) const
+      { return empty() ? r
+          : r.empty() ? *this
+          : CodePointRange((m_min < r.m_min) ? m_min : r.m_min,
+                           (m_max > r.m_max) ? m_max : r.m_max);
       }
       // Intersection
-      CodePointRange operator &(const CodePointRange& r) const
-      { if (!overlaps(r)) return CodePointRange(); // empty range
-
-        return CodePointRange(std::max(m_min, r.m_min),
-                              std::min(m_max, r.m_max));
+      constexpr CodePointRange operator &(const CodePointRange& r) const
+      { return !overlaps(r) ? CodePointRange() // empty range
+          : CodePointRange((m_min > r.m_min) ? m_min : r.m_min,
+                           (m_max < r.m_max) ? m_max : r.m_max);
       }
 
       // Strictly beneath. I've adopted the convention that empty
       // ranges sort below non-empty ranges.
-      bool operator < (const CodePointRange& r) const
-      { if (empty()) return !r.empty();
-        if (r.empty()) return false;
-        return m_max < r.m_min;
+      constexpr bool operator < (const CodePointRange& r) const
+      { return empty() ? !r.empty()
+          : r.empty() ? false
+          : m_max < r.m_min;
       }
       // Strictly above. Empty ranges are non-comparable.
-      bool operator > (const CodePointRange& r) const
-      { if (r.empty()) return !empty();
-        if (empty()) return false;
-        return m_min > r.m_max;
+      constexpr bool operator > (const CodePointRange& r) const
+      { return r.empty() ? !empty()
+          : empty() ? false
+          : m_min > r.m_max;
       }
 
       // Empty ranges can be compared for equality
-      bool operator == (const CodePointRange& r) const
+      constexpr bool operator == (const CodePointRange& r) const
       { return ((m_min == r.m_min) && (m_max == r.m_max)); }
-      bool operator != (const CodePointRange& r) const
+      constexpr bool operator != (const CodePointRange& r) const
       { return ((m_min != r.m_min) || (m_max != r.m_max)); }
 
-      bool isStrictlyBelow(const CodePointRange& r) const
+      constexpr bool isStrictlyBelow(const CodePointRange& r) const
       { return (*this < r); }
-      bool isStrictlyAbove(const CodePointRange& r) const
+      constexpr bool isStrictlyAbove(const CodePointRange& r) const
       { return (*this > r); }
 
-      CodePointRange portionBelow(const CodePointRange& r) const
-      {
-        if (isStrictlyBelow(r))
-          return *this;
-        if(isStrictlyAbove(r) || (m_min >= r.m_min))
-          return CodePointRange();
-
-        // If we are here, then there is overlap from beneath
-        return CodePointRange(m_min, r.m_min-1);
+      constexpr CodePointRange portionBelow(const CodePointRange& r) const
+      { return isStrictlyBelow(r) ? *this
+          : (isStrictlyAbove(r) || (m_min >= r.m_min)) ? CodePointRange()
+          // If we are here, then there is overlap from beneath
+          : CodePointRange(m_min, r.m_min-1);
       }
-      CodePointRange portionAbove(const CodePointRange& r) const
-      {
-        if (isStrictlyAbove(r))
-          return *this;
-        if (isStrictlyBelow(r) || (m_max <= r.m_max))
-          return CodePointRange();
-
-        // There is overlap from above
-        return CodePointRange(r.m_max+1, m_max);
+      constexpr CodePointRange portionAbove(const CodePointRange& r) const
+      { return isStrictlyAbove(r) ? *this
+          : (isStrictlyBelow(r) || (m_max <= r.m_max)) ? CodePointRange()
+          // There is overlap from above
+          : CodePointRange(r.m_max+1, m_max);
       }
 
 #if 0
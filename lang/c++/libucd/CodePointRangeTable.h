@@ -0,0 +1,147 @@
+#ifndef CODEPOINTRANGETABLE_H
+#define CODEPOINTRANGETABLE_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include "CodePointRange.h"
+
+namespace libucd {
+  /// @brief A read-only view of a statically allocated, ascending array
+  /// of disjoint, non-abutting, non-empty code point ranges.
+  ///
+  /// This is the form in which generated property tables are emitted.
+  /// Both construction and lookup are constexpr, so a table costs nothing
+  /// at startup and can be placed in read-only data:
+  ///
+  ///     constexpr CodePointRange XID_Start_ranges[] = { ... };
+  ///     constexpr CodePointRangeTable XID_Start(XID_Start_ranges);
+  ///
+  ///     static_assert(XID_Start.contains('A'), "");
+  ///
+  /// The table does not establish that form, and lookups assume it: in
+  /// particular, contains(const CodePointRange&) misses a range that
+  /// spans two abutting entries. The ranges of a CodePointSet or a
+  /// FrozenCodePointSet, and so the tables compile-props emits, are
+  /// already in this form; isCanonical() checks any other table, e.g. in
+  /// a static_assert.
+  ///
+  /// Use CodePointSet::insert(first, last) on begin() and end() to get a
+  /// mutable copy.
+  class CodePointRangeTable {
+      const CodePointRange *m_ranges;
+      size_t m_size;
+
+      // True if [lo, hi) is ascending, disjoint and non-abutting. Split
+      // in halves like search(), so that the depth is log2 of the size.
+      constexpr bool canonical(size_t lo, size_t hi) const
+      { return (hi - lo < 2) ||
+          (canonical(lo, lo + (hi - lo) / 2) &&
+           separated(lo + (hi - lo) / 2 - 1) &&
+           canonical(lo + (hi - lo) / 2, hi));
+      }
+
+      // True if a gap separates ranges /i/ and /i/ + 1.
+      constexpr bool separated(size_t i) const
+      { return (m_ranges[i].max() < m_ranges[i + 1].min()) &&
+          (m_ranges[i + 1].min() - m_ranges[i].max() > 1);
+      }
+
+      // Binary search of [lo, hi) for the range containing /cp/. C++11
+      // constexpr functions are a single return statement, hence the
+      // recursion; the depth is log2 of the table size.
+      constexpr size_t search(CodePoint_t cp, size_t lo, size_t hi) const
+      { return (lo >= hi) ? m_size : probe(cp, lo, lo + (hi - lo) / 2, hi); }
+
+      constexpr size_t probe(CodePoint_t cp, size_t lo, size_t mid, size_t hi) const
+      { return (cp < m_ranges[mid].min()) ? search(cp, lo, mid)
+          : (cp > m_ranges[mid].max()) ? search(cp, mid + 1, hi)
+          : mid;
+      }
+
+    public:
+      typedef CodePointRange value_type;
+      typedef const CodePointRange *const_iterator;
+      typedef const_iterator iterator;
+
+      constexpr CodePointRangeTable()
+        : m_ranges(nullptr), m_size(0)
+      { }
+
+      template<size_t N>
+      constexpr CodePointRangeTable(const CodePointRange (&ranges)[N])
+        : m_ranges(ranges), m_size(N)
+      { }
+
+      constexpr CodePointRangeTable(const CodePointRange *ranges, size_t size)
+        : m_ranges(ranges), m_size(size)
+      { }
+
+      constexpr const_iterator begin() const { return m_ranges; }
+      constexpr const_iterator end() const { return m_ranges + m_size; }
+
+      constexpr size_t size() const { return m_size; }
+      constexpr bool empty() const { return m_size == 0; }
+
+      constexpr const CodePointRange& operator[](size_t i) const
+      { return m_ranges[i]; }
+
+      /// @brief Return the index of the range containing @p cp, or size()
+      /// if @p cp is not a member.
+      constexpr size_t indexOf(CodePoint_t cp) const
+      { return search(cp, 0, m_size); }
+
+      constexpr bool contains(CodePoint_t cp) const
+      { return indexOf(cp) != m_size; }
+
+      /// @brief True if the ranges are ascending, disjoint and
+      /// non-abutting, as lookups require. Linear in size().
+      constexpr bool isCanonical() const
+      { return canonical(0, m_size); }
+
+      /// @brief True if every code point of @p r is in the table. Since
+      /// the ranges are non-abutting, a contained range lies within the
+      /// range that contains its minimum.
+      constexpr bool contains(const CodePointRange& r) const
+      { return r.empty() ||
+          ((indexOf(r.min()) != m_size) && m_ranges[indexOf(r.min())].contains(r));
+      }
+  };
+}
+
+#endif // CODEPOINTRANGETABLE_H
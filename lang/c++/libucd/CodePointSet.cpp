@@ -37,8 +37,10 @@
  **************************************************************************/
 
 #include <assert.h>
+#include <algorithm>
 #include <iostream>
 #include "CodePointSet.h"
+#include "FrozenCodePointSet.h"
 
 #define DEBUG if (0)
 
@@ -47,6 +49,14 @@ namespace libucd {
   {
   }
 
+  CodePointSet::CodePointSet(const FrozenCodePointSet& frozen)
+  {
+    // The frozen ranges are ascending, disjoint and non-abutting, so
+    // each one goes directly at the end.
+    for (size_t i = 0; i < frozen.size(); i++)
+      m_set.insert(m_set.end(), frozen[i]);
+  }
+
   CodePointSet::~CodePointSet()
   {
   }
@@ -194,8 +204,7 @@ namespace libucd {
   void
   CodePointSet::insert(const CodePointSet &set)
   {
-    for (auto it = set.begin(); it != set.end(); it++)
-      insert(*it);
+    *this = *this | set;
   }
 
   size_t
@@ -253,6 +262,141 @@ namespace libucd {
 
     return nElem;
   }
+
+  namespace {
+    // Walks the boundaries of a range sequence in ascending order. The
+    // boundaries of [min, max] are min and max+1; they are widened to
+    // 64 bits so that the bound of a range ending at the top of
+    // CodePoint_t is representable.
+    class BoundaryCursor {
+        CodePointSet::const_iterator m_it;
+        CodePointSet::const_iterator m_end;
+        bool m_atBound;
+
+      public:
+        static const uint64_t DONE = UINT64_MAX;
+
+        BoundaryCursor(const CodePointSet& set)
+          : m_it(set.begin()), m_end(set.end()), m_atBound(false) {}
+
+        uint64_t value() const
+        {
+          if (m_it == m_end)
+            return DONE;
+          return m_atBound ? (uint64_t) m_it->max() + 1 : m_it->min();
+        }
+
+        void advance()
+        {
+          if (m_atBound)
+            m_it++;
+          m_atBound = !m_atBound;
+        }
+    };
+  }
+
+  template<class Op>
+  CodePointSet
+  CodePointSet::merge(const CodePointSet& a, const CodePointSet& b, Op op)
+  {
+    CodePointSet result;
+
+    BoundaryCursor ca(a);
+    BoundaryCursor cb(b);
+    bool inA = false;
+    bool inB = false;
+    bool inResult = false;
+    uint64_t start = 0;
+
+    for (;;) {
+      uint64_t at = std::min(ca.value(), cb.value());
+      if (at == BoundaryCursor::DONE)
+        break;
+
+      // Ranges within each operand are disjoint and non-abutting, so each
+      // cursor has at most one boundary at /at/.
+      if (ca.value() == at) {
+        inA = !inA;
+        ca.advance();
+      }
+      if (cb.value() == at) {
+        inB = !inB;
+        cb.advance();
+      }
+
+      bool in = op(inA, inB);
+      if (in == inResult)
+        continue;
+
+      if (in) {
+        start = at;
+      }
+      else {
+        // Output ranges are produced in ascending order and are never
+        // abutting, so each one goes directly at the end.
+        result.m_set.insert(result.m_set.end(),
+                            CodePointRange::open(start, at));
+      }
+      inResult = in;
+    }
+
+    // Every operator used below maps (false, false) to false, so the
+    // result is closed once both inputs are exhausted.
+    assert(!inResult);
+
+    return result;
+  }
+
+  namespace {
+    struct OrOp {
+      bool operator()(bool a, bool b) const { return a || b; }
+    };
+    struct AndOp {
+      bool operator()(bool a, bool b) const { return a && b; }
+    };
+    struct MinusOp {
+      bool operator()(bool a, bool b) const { return a && !b; }
+    };
+    struct XorOp {
+      bool operator()(bool a, bool b) const { return a != b; }
+    };
+  }
+
+  CodePointSet
+  CodePointSet::operator |(const CodePointSet& r) const
+  {
+    return merge(*this, r, OrOp());
+  }
+
+  CodePointSet
+  CodePointSet::intersect(const CodePointSet& r) const
+  {
+    return merge(*this, r, AndOp());
+  }
+
+  CodePointSet
+  CodePointSet::operator -(const CodePointSet& r) const
+  {
+    return merge(*this, r, MinusOp());
+  }
+
+  CodePointSet
+  CodePointSet::operator ^(const CodePointSet& r) const
+  {
+    return merge(*this, r, XorOp());
+  }
+
+  CodePointSet
+  CodePointSet::complement() const
+  {
+    return merge(Unicode(), *this, MinusOp());
+  }
+
+  FrozenCodePointSet
+  CodePointSet::freeze() const
+  {
+    return FrozenCodePointSet(*this);
+  }
 }
 
 std::ostream&
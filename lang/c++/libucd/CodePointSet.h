@@ -39,17 +39,42 @@
  *
  **************************************************************************/
 
+#include <cassert>
 #include <set>
 
 #include "CodePointRange.h"
+#include "MemoryResource.h"
+#include "Utf8Iterator.h"
 #include "utf8.h"
 
 namespace libucd {
+  class FrozenCodePointSet;
+
+  /// @brief A set of code points, held as an ordered set of disjoint,
+  /// non-abutting ranges.
+  ///
+  /// The ranges are allocated through a PolymorphicAllocator. A set
+  /// constructed without a MemoryResource, including the result of any
+  /// operator or a copy, uses the calling thread's default resource, so
+  /// the temporaries of a whole computation can be put in a
+  /// MonotonicArena by a DefaultResourceScope around it.
   class CodePointSet
   {
-      typedef typename std::set<CodePointRange> SetType;
+    public:
+      typedef PolymorphicAllocator<CodePointRange> allocator_type;
+
+    private:
+      typedef typename std::set<CodePointRange, std::less<CodePointRange>,
+                                allocator_type> SetType;
       SetType m_set;
 
+      /// @brief Combine two sets in a single ascending pass over their
+      /// range boundaries. A code point is in the result exactly if
+      /// @p op(inA, inB) is true of its membership in @p a and @p b.
+      template<class Op>
+      static CodePointSet merge(const CodePointSet& a, const CodePointSet& b,
+                                Op op);
+
     public:
       typedef typename SetType::key_type key_type;
       typedef typename SetType::value_type value_type;
@@ -61,22 +86,32 @@ namespace libucd {
       typedef typename SetType::value_compare value_compare;
 
       CodePointSet();
-      CodePointSet(const CodePointSet& that) {
-        insert(that);
-      }
+      /// @brief An empty set that allocates from @p resource.
+      explicit CodePointSet(MemoryResource *resource)
+        : m_set(std::less<CodePointRange>(), allocator_type(resource)) {}
+      CodePointSet(const CodePointSet& that) : m_set(that.m_set) {}
+      /// @brief A copy of @p that which allocates from @p resource, e.g.
+      /// to keep a result computed in an arena after it is released.
+      CodePointSet(const CodePointSet& that, MemoryResource *resource)
+        : m_set(that.m_set, allocator_type(resource)) {}
+      CodePointSet(CodePointSet&& that) = default;
       CodePointSet(const std::set<CodePointRange>& s) {
-        for (auto it = s.begin(); it != s.end(); it++)
-          insert(*it);
+        assign_sorted(s.begin(), s.end());
       }
+      explicit CodePointSet(const FrozenCodePointSet& frozen);
+      // The members of a UTF-8 string. Here and in the other operations
+      // taking a string, bytes that are not well-formed UTF-8 are ignored.
       CodePointSet(const char *str) {
-        while (*str) {
-          CodePoint_t c = utf8_decode(str, &str);
-          insert(CodePointRange(c));
-        }
+        for (CodePoint_t c : utf8_range(str))
+          if (c != CODEPOINT_EOF)
+            insert(CodePointRange(c));
       }
 
       ~CodePointSet();
 
+      CodePointSet& operator = (const CodePointSet& that) = default;
+      CodePointSet& operator = (CodePointSet&& that) = default;
+
       iterator begin()        noexcept { return m_set.begin(); }
       const_iterator begin()  const noexcept { return m_set.begin(); }
       const_iterator cbegin() const noexcept { return m_set.cbegin(); }
@@ -113,6 +148,9 @@ namespace libucd {
       std:: pair <const_iterator, const_iterator> equal_range(const CodePointRange& r) const
       { return m_set.equal_range(r); }
 
+      allocator_type get_allocator() const { return m_set.get_allocator(); }
+      MemoryResource *resource() const { return m_set.get_allocator().resource(); }
+
       value_compare key_comp() const { return m_set.key_comp(); }
       value_compare value_comp() const { return m_set.value_comp(); }
 
@@ -156,6 +194,53 @@ namespace libucd {
       void insert(std::initializer_list<value_type> il)
       { insert(il.begin(), il.end()); }
 
+      /// @brief Append the ranges in [@p first, @p last), which must be
+      /// ordered by ascending min() and must not start before the last
+      /// range already in the set. Overlapping and abutting ranges are
+      /// coalesced as they arrive and each result is placed directly at
+      /// the end, so this is linear in the number of input ranges.
+      template<class InputIterator>
+      void append_sorted(InputIterator first, InputIterator last) {
+        // /run/ is the range being built. /inSet/ is true while it is
+        // still the unmodified last range of m_set.
+        CodePointRange run;
+        bool inSet = !m_set.empty();
+        if (inSet)
+          run = *m_set.rbegin();
+
+        for (; first != last; ++first) {
+          const CodePointRange& r = *first;
+          if (r.empty())
+            continue;
+          assert(run.empty() || (run.min() <= r.min()));
+
+          if (run.canMergeWith(r)) {
+            if (inSet && !run.contains(r)) {
+              m_set.erase(--m_set.end());
+              inSet = false;
+            }
+            run = run | r;
+            continue;
+          }
+
+          if (!inSet)
+            m_set.insert(m_set.end(), run);
+          run = r;
+          inSet = false;
+        }
+
+        if (!inSet && !run.empty())
+          m_set.insert(m_set.end(), run);
+      }
+
+      /// @brief Replace the contents of this set with the ranges in
+      /// [@p first, @p last), which must be ordered by ascending min().
+      template<class InputIterator>
+      void assign_sorted(InputIterator first, InputIterator last) {
+        m_set.clear();
+        append_sorted(first, last);
+      }
+
       // A similar problem arises with erase() in the case where an instance
       // of value_type is passed. We return the number of elements that are
       // **modified** or erased.
@@ -183,10 +268,9 @@ namespace libucd {
         return *this;
       }
       CodePointSet operator += (const char *str) {
-        while (*str) {
-          CodePoint_t c = utf8_decode(str, &str);
-          insert(CodePointRange(c));
-        }
+        for (CodePoint_t c : utf8_range(str))
+          if (c != CODEPOINT_EOF)
+            insert(CodePointRange(c));
         return *this;
       }
 
@@ -195,28 +279,24 @@ namespace libucd {
         return *this;
       }
       CodePointSet& operator -= (const CodePointSet& set) {
-        erase(set);
+        *this = *this - set;
         return *this;
       }
       CodePointSet operator -= (const char *str) {
-        while (*str) {
-          CodePoint_t c = utf8_decode(str, &str);
-          erase(CodePointRange(c));
-        }
+        for (CodePoint_t c : utf8_range(str))
+          if (c != CODEPOINT_EOF)
+            erase(CodePointRange(c));
         return *this;
       }
 
       CodePointSet operator + (const CodePointSet& set) const {
-        CodePointSet result = *this;
-        result += set;
-        return result;
+        return (*this) | set;
       }
       CodePointSet operator + (const char *str) const {
         CodePointSet result = *this;
-        while (*str) {
-          CodePoint_t c = utf8_decode(str, &str);
-          result.insert(CodePointRange(c));
-        }
+        for (CodePoint_t c : utf8_range(str))
+          if (c != CODEPOINT_EOF)
+            result.insert(CodePointRange(c));
         return result;
       }
       CodePointSet operator + (const CodePointRange& r) const {
@@ -225,17 +305,15 @@ namespace libucd {
         return result;
       }
 
-      CodePointSet operator - (const CodePointSet& set) const {
-        CodePointSet result = *this;
-        result -= set;
-        return result;
-      }
+      // Set algebra. These are computed by a single merge over the two
+      // sorted range sequences, so they are linear in the number of
+      // ranges in the two operands.
+      CodePointSet operator - (const CodePointSet& set) const;
       CodePointSet operator - (const char *str) const {
         CodePointSet result = *this;
-        while (*str) {
-          CodePoint_t c = utf8_decode(str, &str);
-          result -= CodePointRange(c);
-        }
+        for (CodePoint_t c : utf8_range(str))
+          if (c != CODEPOINT_EOF)
+            result -= CodePointRange(c);
         return result;
       }
       CodePointSet operator - (const CodePointRange& r) const {
@@ -244,12 +322,7 @@ namespace libucd {
         return result;
       }
 
-      CodePointSet intersect(const CodePointSet& r) const {
-        CodePointSet unique = *this;
-        unique -= r;
-        // What's left in /result/ is the items that were unique to /result/.
-        return (*this - unique);
-      }
+      CodePointSet intersect(const CodePointSet& r) const;
 
       CodePointSet operator &(const CodePointSet& r) const {
         return this->intersect(r);
@@ -260,15 +333,29 @@ namespace libucd {
         return *this;
       }
 
-      CodePointSet operator |(const CodePointSet& r) const {
-        return (*this) + r;
-      }
+      CodePointSet operator |(const CodePointSet& r) const;
       CodePointSet& operator |= (const CodePointSet& r) {
-        this->insert(r);
+        *this = *this | r;
+        return *this;
+      }
+
+      // Symmetric difference
+      CodePointSet operator ^(const CodePointSet& r) const;
+      CodePointSet& operator ^= (const CodePointSet& r) {
+        *this = *this ^ r;
         return *this;
       }
 
+      /// @brief Complement with respect to the Unicode code space
+      /// [0, CODEPOINT_MAX]. Members above CODEPOINT_MAX are dropped.
+      CodePointSet complement() const;
+      CodePointSet operator ~() const { return complement(); }
+
       size_t NumCodePoints() const;
+
+      /// @brief Return an immutable, contiguous copy of this set that is
+      /// cheaper to store and to query.
+      FrozenCodePointSet freeze() const;
   };
 }
 
@@ -0,0 +1,150 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <iostream>
+#include "FrozenCodePointSet.h"
+#include "CodePointSet.h"
+
+namespace libucd {
+  FrozenCodePointSet::FrozenCodePointSet(const CodePointSet& set)
+  {
+    m_bounds.reserve(set.size() * 2);
+
+    for (auto it = set.begin(); it != set.end(); it++) {
+      m_bounds.push_back(it->min());
+      if (it->max() != CODEPOINT_EOF)
+        m_bounds.push_back(it->max() + 1);
+    }
+  }
+
+  CodePointSet
+  FrozenCodePointSet::thaw() const
+  {
+    return CodePointSet(*this);
+  }
+
+  const unsigned FrozenCodePointSet::BLOCK_BITS;
+  const CodePoint_t FrozenCodePointSet::BLOCK_SIZE;
+  const size_t FrozenCodePointSet::NUM_BLOCKS;
+
+  // Number of the /n/ sorted boundaries at /bounds/ that are less than
+  // or equal to /cp/.
+  static inline size_t
+  countUpTo(const CodePoint_t *bounds, size_t n, CodePoint_t cp)
+  {
+    if (n == 0)
+      return 0;
+
+    // Branchless binary search: the loop trip count depends only on
+    // /n/, and the body compiles to a conditional move.
+    const CodePoint_t *base = bounds;
+    while (n > 1) {
+      size_t half = n / 2;
+      base = (base[half] <= cp) ? base + half : base;
+      n -= half;
+    }
+
+    return (base - bounds) + (*base <= cp);
+  }
+
+  size_t
+  FrozenCodePointSet::countBoundsUpTo(CodePoint_t cp) const
+  {
+    if (!m_blocks.empty() && cp <= CODEPOINT_MAX) {
+      // Only the boundaries inside the block of /cp/ need searching.
+      size_t b = cp >> BLOCK_BITS;
+      uint32_t lo = m_blocks[b];
+      return lo + countUpTo(m_bounds.data() + lo, m_blocks[b + 1] - lo, cp);
+    }
+
+    return countUpTo(m_bounds.data(), m_bounds.size(), cp);
+  }
+
+  void
+  FrozenCodePointSet::buildIndex()
+  {
+    m_blocks.resize(NUM_BLOCKS + 1);
+
+    size_t i = 0;
+    for (size_t b = 0; b <= NUM_BLOCKS; b++) {
+      CodePoint_t start = CodePoint_t(b) << BLOCK_BITS;
+      while (i < m_bounds.size() && m_bounds[i] < start)
+        i++;
+      m_blocks[b] = uint32_t(i);
+    }
+  }
+
+  bool
+  FrozenCodePointSet::contains(const CodePointRange& range) const
+  {
+    if (range.empty())
+      return true;
+
+    size_t ndx = countBoundsUpTo(range.min());
+    if ((ndx & 1) == 0)
+      return false;
+
+    // The containing range runs up to m_bounds[ndx], if present.
+    return (ndx == m_bounds.size()) || (range.max() < m_bounds[ndx]);
+  }
+
+  size_t
+  FrozenCodePointSet::NumCodePoints() const
+  {
+    size_t nElem = 0;
+    for (size_t i = 0; i < size(); i++)
+      nElem += (*this)[i].size();
+
+    return nElem;
+  }
+}
+
+std::ostream&
+operator<< (std::ostream& os, const libucd::FrozenCodePointSet& r)
+{
+  os << "{";
+  const char *sep = " ";
+
+  for (size_t i = 0; i < r.size(); i++) {
+    os << sep << r[i];
+    sep = "\n  ";
+  }
+  os << " }";
+
+  return os;
+}
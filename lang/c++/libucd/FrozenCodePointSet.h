@@ -0,0 +1,147 @@
+#ifndef FROZENCODEPOINTSET_H
+#define FROZENCODEPOINTSET_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <stdint.h>
+#include <vector>
+
+#include "CodePointRange.h"
+
+namespace libucd {
+  class CodePointSet;
+
+  /// @brief Immutable, contiguous representation of a code point set.
+  ///
+  /// A CodePointSet is convenient to build, but it costs a heap node
+  /// per range and a pointer chase per step of every lookup. Once a set
+  /// has been built it is rarely modified again, so it can be frozen
+  /// into a sorted vector of range boundaries (an "inversion list"):
+  ///
+  ///   m_bounds[2i]   is the base of the i'th range, and
+  ///   m_bounds[2i+1] is its (exclusive) bound.
+  ///
+  /// A code point is a member exactly if an odd number of boundaries
+  /// are less than or equal to it. If the last range extends to the top
+  /// of CodePoint_t its bound is not representable, and is omitted.
+  ///
+  /// Use CodePointSet::freeze() or the converting constructor to build
+  /// one, and thaw() to get back a mutable CodePointSet.
+  ///
+  /// A set can optionally be given a block index (see buildIndex()).
+  /// The code space is cut into blocks of BLOCK_SIZE code points. The
+  /// index records, for each block, how many boundaries lie below its
+  /// start. The boundaries that fall inside the block are then the ones
+  /// between its entry and the next. For most blocks of a real
+  /// property there are none, and the block is wholly in or wholly out
+  /// of the set. Such lookups need no search, and the rest search only
+  /// the few boundaries of one block.
+  class FrozenCodePointSet
+  {
+      std::vector<CodePoint_t> m_bounds;
+
+      /// @brief m_blocks[b] is the number of boundaries below
+      /// b * BLOCK_SIZE, for b in [0, NUM_BLOCKS]; empty if the set has
+      /// no index.
+      std::vector<uint32_t> m_blocks;
+
+      /// @brief Number of boundaries that are less than or equal to @p cp.
+      size_t countBoundsUpTo(CodePoint_t cp) const;
+
+    public:
+      typedef CodePointRange value_type;
+
+      static const unsigned BLOCK_BITS = 8;
+      static const CodePoint_t BLOCK_SIZE = 1u << BLOCK_BITS;
+      static const size_t NUM_BLOCKS = (CODEPOINT_MAX + 1) / BLOCK_SIZE;
+
+      FrozenCodePointSet() {}
+      explicit FrozenCodePointSet(const CodePointSet& set);
+
+      CodePointSet thaw() const;
+
+      /// @brief Number of ranges in the set.
+      size_t size() const { return (m_bounds.size() + 1) / 2; }
+      bool empty() const { return m_bounds.empty(); }
+
+      /// @brief Return the @p i'th range of the set, in ascending order.
+      CodePointRange operator[](size_t i) const
+      {
+        CodePoint_t base = m_bounds[2 * i];
+        if ((2 * i + 1) == m_bounds.size())
+          return CodePointRange(base, CODEPOINT_EOF);
+        return CodePointRange::open(base, m_bounds[2 * i + 1]);
+      }
+
+      bool contains(CodePoint_t cp) const
+      { return (countBoundsUpTo(cp) & 1) != 0; }
+      bool contains(const CodePointRange& range) const;
+
+      size_t NumCodePoints() const;
+
+      /// @brief Build the block index, which takes
+      /// (NUM_BLOCKS + 1) * 4 bytes, about 17 KB, whatever the size of
+      /// the set. Worthwhile for sets that are queried often and have
+      /// more than a handful of ranges.
+      void buildIndex();
+
+      /// @brief Discard the block index.
+      void dropIndex() { std::vector<uint32_t>().swap(m_blocks); }
+
+      bool hasIndex() const { return !m_blocks.empty(); }
+
+      /// @brief Bytes of heap storage used by the set and its index.
+      size_t memoryUsage() const
+      {
+        return m_bounds.capacity() * sizeof(CodePoint_t) +
+          m_blocks.capacity() * sizeof(uint32_t);
+      }
+
+      const std::vector<CodePoint_t>& bounds() const { return m_bounds; }
+
+      bool operator == (const FrozenCodePointSet& that) const
+      { return m_bounds == that.m_bounds; }
+      bool operator != (const FrozenCodePointSet& that) const
+      { return m_bounds != that.m_bounds; }
+  };
+}
+
+std::ostream& operator<< (std::ostream&, const libucd::FrozenCodePointSet&);
+
+#endif // FROZENCODEPOINTSET_H
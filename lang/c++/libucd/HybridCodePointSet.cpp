@@ -0,0 +1,99 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+
+#include "CodePointSet.h"
+#include "HybridCodePointSet.h"
+
+namespace libucd {
+  HybridCodePointSet::HybridCodePointSet(const CodePointSet& set, Layout layout)
+  {
+    const CodePointRange bmp = CodePointRange::open(0, BMP_LIMIT);
+
+    if (layout == LAYOUT_AUTO) {
+      size_t nBmpRanges = 0;
+      for (auto it = set.begin(); it != set.end() && it->min() < BMP_LIMIT; it++)
+        nBmpRanges++;
+      layout = (nBmpRanges >= BITMAP_THRESHOLD) ? LAYOUT_BITMAP : LAYOUT_RANGES;
+    }
+
+    if (layout == LAYOUT_RANGES) {
+      m_ranges = FrozenCodePointSet(set);
+      return;
+    }
+
+    m_bitmap.assign(BITMAP_WORDS, 0);
+    for (auto it = set.begin(); it != set.end() && it->min() < BMP_LIMIT; it++) {
+      CodePoint_t last = std::min(it->max(), BMP_LIMIT - 1);
+      for (CodePoint_t cp = it->min(); cp <= last; cp++)
+        m_bitmap[cp >> 6] |= uint64_t(1) << (cp & 63);
+    }
+
+    m_ranges = FrozenCodePointSet(set - (CodePointSet() + bmp));
+  }
+
+  CodePointSet
+  HybridCodePointSet::thaw() const
+  {
+    if (!usesBitmap())
+      return m_ranges.thaw();
+
+    // Recover the BMP ranges from runs of set bits. They all precede the
+    // supplementary ranges, so the whole set can be built in order.
+    std::vector<CodePointRange> ranges;
+    CodePoint_t cp = 0;
+    while (cp < BMP_LIMIT) {
+      if (!contains(cp)) {
+        cp++;
+        continue;
+      }
+
+      CodePoint_t first = cp;
+      while (cp < BMP_LIMIT && contains(cp))
+        cp++;
+      ranges.push_back(CodePointRange(first, cp - 1));
+    }
+    for (size_t i = 0; i < m_ranges.size(); i++)
+      ranges.push_back(m_ranges[i]);
+
+    CodePointSet set;
+    set.assign_sorted(ranges.begin(), ranges.end());
+    return set;
+  }
+}
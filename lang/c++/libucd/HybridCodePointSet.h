@@ -0,0 +1,104 @@
+#ifndef HYBRIDCODEPOINTSET_H
+#define HYBRIDCODEPOINTSET_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <stdint.h>
+#include <vector>
+
+#include "FrozenCodePointSet.h"
+
+namespace libucd {
+  class CodePointSet;
+
+  /// @brief Immutable code point set that keeps the Basic Multilingual
+  /// Plane as a bitmap.
+  ///
+  /// Properties such as Alphabetic or ID_Continue break up into thousands
+  /// of short ranges within the BMP, where even a frozen range search
+  /// takes a dozen dependent steps. Here the BMP portion can instead be
+  /// held as a fixed 8 KB bitmap, making membership a single bit test,
+  /// while the (usually much simpler) supplementary planes stay in a
+  /// FrozenCodePointSet.
+  ///
+  /// With LAYOUT_AUTO, the bitmap is used when the BMP portion of the set
+  /// has at least BITMAP_THRESHOLD ranges; below that, a range search is
+  /// short enough that the extra 8 KB does not pay for itself.
+  class HybridCodePointSet
+  {
+    public:
+      enum Layout {
+        LAYOUT_AUTO,
+        LAYOUT_BITMAP,
+        LAYOUT_RANGES
+      };
+
+      static const CodePoint_t BMP_LIMIT = 0x10000;
+      static const size_t BITMAP_WORDS = BMP_LIMIT / 64;
+      static const size_t BITMAP_THRESHOLD = 64;
+
+    private:
+      std::vector<uint64_t> m_bitmap;   // BMP bits, or empty
+      FrozenCodePointSet m_ranges;      // everything not in m_bitmap
+
+    public:
+      HybridCodePointSet() {}
+      explicit HybridCodePointSet(const CodePointSet& set,
+                                  Layout layout = LAYOUT_AUTO);
+
+      CodePointSet thaw() const;
+
+      bool usesBitmap() const { return !m_bitmap.empty(); }
+
+      bool contains(CodePoint_t cp) const
+      {
+        if (cp < BMP_LIMIT && usesBitmap())
+          return (m_bitmap[cp >> 6] >> (cp & 63)) & 1;
+        return m_ranges.contains(cp);
+      }
+
+      /// @brief Bytes of heap storage used by the set.
+      size_t memoryUsage() const
+      {
+        return m_bitmap.capacity() * sizeof(uint64_t) + m_ranges.memoryUsage();
+      }
+  };
+}
+
+#endif // HYBRIDCODEPOINTSET_H
@@ -0,0 +1,144 @@
+#ifndef LOOSEMATCH_H
+#define LOOSEMATCH_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace libucd {
+  /// @brief Loose matching of property and property value names, as
+  /// given by UAX44-LM3: case, whitespace, underscores and hyphens are
+  /// ignored, as is an initial prefix "is". Thus "General_Category",
+  /// "general category" and "isGeneralCategory" all match.
+  ///
+  /// Names are compared in place, so nothing is allocated and there is
+  /// no separate pass to normalize a name before it is hashed or
+  /// compared. Only ASCII case is folded; property and value names are
+  /// all ASCII.
+
+  /// @brief True if @p c is ignored by loose matching.
+  inline bool
+  loose_ignored(unsigned char c)
+  {
+    return c == ' ' || c == '_' || c == '-' || (c >= '\t' && c <= '\r');
+  }
+
+  /// @brief @p c with ASCII upper case folded to lower case.
+  inline unsigned char
+  loose_fold(unsigned char c)
+  {
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+  }
+
+  /// @brief Offset of the first significant byte of the name
+  /// [s, s + len): leading ignored bytes are skipped, and so is a prefix
+  /// "is" unless nothing would remain after it.
+  inline size_t
+  loose_start(const char *s, size_t len)
+  {
+    size_t i = 0;
+    while (i < len && loose_ignored(s[i]))
+      i++;
+
+    if (i + 1 < len && loose_fold(s[i]) == 'i') {
+      size_t j = i + 1;
+      while (j < len && loose_ignored(s[j]))
+        j++;
+      if (j < len && loose_fold(s[j]) == 's') {
+        for (j++; j < len; j++) {
+          if (!loose_ignored(s[j]))
+            return j;
+        }
+      }
+    }
+
+    return i;
+  }
+
+  /// @brief Final mixing step of MurmurHash3, used to spread the bits of
+  /// a hash before it is reduced modulo a table size.
+  inline uint64_t
+  loose_mix(uint64_t h)
+  {
+    h ^= h >> 33;
+    h *= UINT64_C(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+    h *= UINT64_C(0xc4ceb9fe1a85ec53);
+    h ^= h >> 33;
+    return h;
+  }
+
+  /// @brief Hash of the name [s, s + len) under loose matching: names
+  /// that match loosely hash alike. @p seed selects one of a family of
+  /// hash functions; it is applied after the bytes are hashed, since
+  /// seeding FNV-1a's initial state makes short names whose bytes
+  /// differ as the seeds do hash alike.
+  inline uint64_t
+  loose_hash(const char *s, size_t len, uint64_t seed)
+  {
+    uint64_t h = UINT64_C(0xcbf29ce484222325);
+    for (size_t i = loose_start(s, len); i < len; i++) {
+      unsigned char c = s[i];
+      if (!loose_ignored(c)) {
+        h ^= loose_fold(c);
+        h *= UINT64_C(0x100000001b3);
+      }
+    }
+    return loose_mix(h ^ seed);
+  }
+
+  /// @brief True if the name [s, s + len) loosely matches @p key, a
+  /// NUL-terminated name already in loose form: lower case, with no
+  /// ignored bytes and no "is" prefix.
+  inline bool
+  loose_equal(const char *s, size_t len, const char *key)
+  {
+    for (size_t i = loose_start(s, len); i < len; i++) {
+      unsigned char c = s[i];
+      if (loose_ignored(c))
+        continue;
+      if (loose_fold(c) != (unsigned char) *key++)
+        return false;
+    }
+    return *key == '\0';
+  }
+}
+
+#endif // LOOSEMATCH_H
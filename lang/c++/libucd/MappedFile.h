@@ -0,0 +1,83 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <stddef.h>
+#include <string>
+
+namespace libucd {
+  /// @brief A read-only memory mapping of an entire file.
+  ///
+  /// The UCD XML files are far too large to read into memory, and we only
+  /// ever make a single forward pass over them, so by default they are
+  /// mapped and the kernel is told to expect sequential access. Pages
+  /// that have been scanned can be dropped under memory pressure.
+  ///
+  /// Binary property databases are queried in place instead, so they
+  /// are mapped for random access. Read-only mappings of the same file
+  /// share their pages with every other process that maps it.
+  class MappedFile {
+      std::string m_path;
+      const char *m_data;
+      size_t m_size;
+
+      MappedFile(const MappedFile&);             // not copyable
+      MappedFile& operator=(const MappedFile&);
+
+    public:
+      enum Access {
+        ACCESS_SEQUENTIAL,
+        ACCESS_RANDOM
+      };
+
+      /// @brief Map @p path. Throws std::runtime_error on failure.
+      explicit MappedFile(const std::string& path,
+                          Access access = ACCESS_SEQUENTIAL);
+      ~MappedFile();
+
+      const std::string& path() const { return m_path; }
+      const char *data() const { return m_data; }
+      size_t size() const { return m_size; }
+      const char *begin() const { return m_data; }
+      const char *end() const { return m_data + m_size; }
+  };
+}
+
+#endif // MAPPEDFILE_H
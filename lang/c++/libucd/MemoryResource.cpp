@@ -0,0 +1,147 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+#include <new>
+#include <stdint.h>
+
+#include "MemoryResource.h"
+
+namespace libucd {
+  const size_t MemoryResource::MAX_ALIGN;
+  const size_t MonotonicArena::DEFAULT_CHUNK_SIZE;
+
+  MemoryResource::~MemoryResource()
+  {
+  }
+
+  namespace {
+    class NewDeleteResource : public MemoryResource {
+        void *do_allocate(size_t bytes, size_t /* alignment */)
+        {
+          // operator new aligns for any fundamental type, which is all
+          // that PolymorphicAllocator asks for.
+          return ::operator new(bytes);
+        }
+
+        void do_deallocate(void *p, size_t, size_t)
+        {
+          ::operator delete(p);
+        }
+    };
+
+    NewDeleteResource newDelete;
+    thread_local MemoryResource *defaultResource = &newDelete;
+  }
+
+  MemoryResource *
+  new_delete_resource() noexcept
+  {
+    return &newDelete;
+  }
+
+  MemoryResource *
+  get_default_resource() noexcept
+  {
+    return defaultResource;
+  }
+
+  MemoryResource *
+  set_default_resource(MemoryResource *resource) noexcept
+  {
+    MemoryResource *previous = defaultResource;
+    defaultResource = resource ? resource : &newDelete;
+    return previous;
+  }
+
+  MonotonicArena::MonotonicArena(size_t initialChunkSize,
+                                 MemoryResource *upstream)
+    : m_upstream(upstream), m_chunks(0), m_cur(0), m_end(0),
+      m_nextChunkSize(std::max<size_t>(initialChunkSize, 256)),
+      m_initialChunkSize(m_nextChunkSize), m_bytesAllocated(0)
+  {
+  }
+
+  MonotonicArena::~MonotonicArena()
+  {
+    release();
+  }
+
+  void *
+  MonotonicArena::do_allocate(size_t bytes, size_t alignment)
+  {
+    uintptr_t cur = reinterpret_cast<uintptr_t>(m_cur);
+    size_t pad = (alignment - (cur & (alignment - 1))) & (alignment - 1);
+
+    if (!m_cur || pad + bytes > size_t(m_end - m_cur)) {
+      // Chunks double in size, so the number of upstream allocations is
+      // logarithmic in the total; an oversized request gets a chunk of
+      // its own size.
+      size_t header = (sizeof(Chunk) + MAX_ALIGN - 1) & ~(MAX_ALIGN - 1);
+      size_t size = std::max(m_nextChunkSize, header + bytes + alignment);
+      Chunk *chunk = static_cast<Chunk *>(m_upstream->allocate(size));
+      chunk->next = m_chunks;
+      chunk->size = size;
+      m_chunks = chunk;
+      m_cur = reinterpret_cast<char *>(chunk) + header;
+      m_end = reinterpret_cast<char *>(chunk) + size;
+      m_nextChunkSize *= 2;
+
+      cur = reinterpret_cast<uintptr_t>(m_cur);
+      pad = (alignment - (cur & (alignment - 1))) & (alignment - 1);
+    }
+
+    void *p = m_cur + pad;
+    m_cur += pad + bytes;
+    m_bytesAllocated += pad + bytes;
+    return p;
+  }
+
+  void
+  MonotonicArena::release()
+  {
+    while (m_chunks) {
+      Chunk *next = m_chunks->next;
+      m_upstream->deallocate(m_chunks, m_chunks->size);
+      m_chunks = next;
+    }
+    m_cur = m_end = 0;
+    m_nextChunkSize = m_initialChunkSize;
+    m_bytesAllocated = 0;
+  }
+}
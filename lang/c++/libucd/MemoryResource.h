@@ -0,0 +1,200 @@
+#ifndef MEMORYRESOURCE_H
+#define MEMORYRESOURCE_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <cstddef>
+
+namespace libucd {
+  /// @brief A source of memory for containers, after C++17's
+  /// std::pmr::memory_resource, which C++11 lacks.
+  ///
+  /// Containers that hold a PolymorphicAllocator draw their memory from
+  /// the resource it names, so the same container type can allocate
+  /// from the heap or from an arena.
+  class MemoryResource
+  {
+    protected:
+      virtual void *do_allocate(size_t bytes, size_t alignment) = 0;
+      virtual void do_deallocate(void *p, size_t bytes, size_t alignment) = 0;
+      virtual bool do_is_equal(const MemoryResource& that) const noexcept
+      { return this == &that; }
+
+    public:
+      static const size_t MAX_ALIGN = alignof(std::max_align_t);
+
+      virtual ~MemoryResource();
+
+      void *allocate(size_t bytes, size_t alignment = MAX_ALIGN)
+      { return do_allocate(bytes, alignment); }
+
+      void deallocate(void *p, size_t bytes, size_t alignment = MAX_ALIGN)
+      { do_deallocate(p, bytes, alignment); }
+
+      /// @brief True if memory allocated from either resource can be
+      /// deallocated through the other.
+      bool is_equal(const MemoryResource& that) const noexcept
+      { return do_is_equal(that); }
+  };
+
+  /// @brief The resource that allocates with operator new and releases
+  /// with operator delete.
+  MemoryResource *new_delete_resource() noexcept;
+
+  /// @brief The resource used by default-constructed allocators on the
+  /// calling thread. Initially new_delete_resource().
+  MemoryResource *get_default_resource() noexcept;
+
+  /// @brief Make @p resource (or new_delete_resource(), if null) the
+  /// default for the calling thread and return the previous default.
+  MemoryResource *set_default_resource(MemoryResource *resource) noexcept;
+
+  /// @brief Makes a resource the calling thread's default for the
+  /// lifetime of the scope, and restores the previous one on exit.
+  class DefaultResourceScope
+  {
+      MemoryResource *m_previous;
+
+    public:
+      explicit DefaultResourceScope(MemoryResource *resource)
+        : m_previous(set_default_resource(resource)) {}
+      ~DefaultResourceScope() { set_default_resource(m_previous); }
+
+      DefaultResourceScope(const DefaultResourceScope&) = delete;
+      DefaultResourceScope& operator=(const DefaultResourceScope&) = delete;
+  };
+
+  /// @brief A resource that hands out memory by advancing a pointer
+  /// through large chunks, and frees nothing until it is released or
+  /// destroyed.
+  ///
+  /// Suited to a phase of work that builds and discards many temporary
+  /// containers: each allocation is a few instructions, deallocation is
+  /// free, and everything the phase allocated is returned to the
+  /// upstream resource in one go. Containers allocated from an arena
+  /// must not be used after it is released. An arena is not thread-safe.
+  class MonotonicArena : public MemoryResource
+  {
+      struct Chunk {
+        Chunk *next;
+        size_t size;
+      };
+
+      MemoryResource *m_upstream;
+      Chunk *m_chunks;
+      char *m_cur;
+      char *m_end;
+      size_t m_nextChunkSize;
+      size_t m_initialChunkSize;
+      size_t m_bytesAllocated;
+
+      void *do_allocate(size_t bytes, size_t alignment);
+      void do_deallocate(void *, size_t, size_t) {}
+
+    public:
+      static const size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+      explicit MonotonicArena(size_t initialChunkSize = DEFAULT_CHUNK_SIZE,
+                              MemoryResource *upstream = new_delete_resource());
+      ~MonotonicArena();
+
+      MonotonicArena(const MonotonicArena&) = delete;
+      MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+      /// @brief Return all chunks to the upstream resource.
+      void release();
+
+      /// @brief Bytes handed out since construction or the last
+      /// release(), including alignment padding.
+      size_t bytesAllocated() const { return m_bytesAllocated; }
+  };
+
+  /// @brief An allocator that draws from a MemoryResource, after C++17's
+  /// std::pmr::polymorphic_allocator.
+  ///
+  /// A default-constructed allocator uses the calling thread's default
+  /// resource. As with std::pmr, a copy of a container takes the default
+  /// resource at the time of the copy, not the original's resource, and
+  /// assignment keeps the target's resource.
+  template<class T>
+  class PolymorphicAllocator
+  {
+      MemoryResource *m_resource;
+
+    public:
+      typedef T value_type;
+
+      PolymorphicAllocator() noexcept : m_resource(get_default_resource()) {}
+      PolymorphicAllocator(MemoryResource *resource) noexcept
+        : m_resource(resource ? resource : get_default_resource()) {}
+      template<class U>
+      PolymorphicAllocator(const PolymorphicAllocator<U>& that) noexcept
+        : m_resource(that.resource()) {}
+
+      T *allocate(size_t n)
+      {
+        return static_cast<T *>(m_resource->allocate(n * sizeof(T), alignof(T)));
+      }
+      void deallocate(T *p, size_t n)
+      {
+        m_resource->deallocate(p, n * sizeof(T), alignof(T));
+      }
+
+      PolymorphicAllocator select_on_container_copy_construction() const
+      { return PolymorphicAllocator(); }
+
+      MemoryResource *resource() const noexcept { return m_resource; }
+  };
+
+  template<class T, class U>
+  inline bool
+  operator==(const PolymorphicAllocator<T>& a, const PolymorphicAllocator<U>& b) noexcept
+  {
+    return a.resource() == b.resource() || a.resource()->is_equal(*b.resource());
+  }
+
+  template<class T, class U>
+  inline bool
+  operator!=(const PolymorphicAllocator<T>& a, const PolymorphicAllocator<U>& b) noexcept
+  {
+    return !(a == b);
+  }
+}
+
+#endif // MEMORYRESOURCE_H
@@ -0,0 +1,220 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <stdexcept>
+#include <string.h>
+#include <type_traits>
+
+#include "UcdDatabase.h"
+
+namespace libucd {
+  // Range tables are used in place as arrays of CodePointRange.
+  static_assert(sizeof(CodePointRange) == 2 * sizeof(CodePoint_t) &&
+                std::is_standard_layout<CodePointRange>::value,
+                "CodePointRange must be a (min, max) pair");
+
+  const size_t UcdDatabase::npos;
+
+  UcdDatabase::UcdDatabase(const std::string& path)
+    : m_file(path, MappedFile::ACCESS_RANDOM),
+      m_header(0), m_properties(0), m_values(0), m_aliases(0), m_ranges(0)
+  {
+    const char *base = m_file.data();
+    m_header = reinterpret_cast<const UcdDbHeader *>(base);
+    validate();
+
+    m_properties = reinterpret_cast<const UcdDbProperty *>(base + m_header->properties.offset);
+    m_values = reinterpret_cast<const UcdDbValue *>(base + m_header->values.offset);
+    m_aliases = reinterpret_cast<const UcdDbAlias *>(base + m_header->aliases.offset);
+    m_ranges = reinterpret_cast<const CodePointRange *>(base + m_header->ranges.offset);
+  }
+
+  void
+  UcdDatabase::validate() const
+  {
+    const std::string& path = m_file.path();
+    size_t size = m_file.size();
+
+    if (size < sizeof(UcdDbHeader) ||
+        memcmp(m_header->magic, UCDDB_MAGIC, sizeof(UCDDB_MAGIC)) != 0)
+      throw std::runtime_error(path + ": not a UCD property database");
+    if (m_header->byteOrder != UCDDB_BYTE_ORDER)
+      throw std::runtime_error(path + ": database has the wrong byte order");
+    if (m_header->formatVersion != UCDDB_FORMAT_VERSION)
+      throw std::runtime_error(path + ": unsupported database format version");
+    if (m_header->fileSize != size)
+      throw std::runtime_error(path + ": database is truncated");
+
+    const UcdDbTable *tables[] = {
+      &m_header->properties, &m_header->values, &m_header->aliases,
+      &m_header->ranges, &m_header->strings
+    };
+    const size_t elementSizes[] = {
+      sizeof(UcdDbProperty), sizeof(UcdDbValue), sizeof(UcdDbAlias),
+      sizeof(CodePointRange), 1
+    };
+    for (size_t i = 0; i < 5; i++) {
+      uint64_t end = tables[i]->offset + uint64_t(tables[i]->count) * elementSizes[i];
+      if ((tables[i]->offset % 4) != 0 || end > size)
+        throw std::runtime_error(path + ": database table out of bounds");
+    }
+
+    const UcdDbTable& strings = m_header->strings;
+    const char *base = m_file.data();
+    if (strings.count == 0 || base[strings.offset + strings.count - 1] != 0)
+      throw std::runtime_error(path + ": database string pool is not terminated");
+
+    auto badString = [&](uint32_t s) {
+      return s < strings.offset || s >= strings.offset + strings.count;
+    };
+    auto fail = [&]() {
+      throw std::runtime_error(path + ": database is inconsistent");
+    };
+
+    if (badString(m_header->unicodeVersion))
+      fail();
+
+    const UcdDbProperty *properties =
+      reinterpret_cast<const UcdDbProperty *>(base + m_header->properties.offset);
+    const UcdDbValue *values =
+      reinterpret_cast<const UcdDbValue *>(base + m_header->values.offset);
+    const UcdDbAlias *aliases =
+      reinterpret_cast<const UcdDbAlias *>(base + m_header->aliases.offset);
+
+    for (uint32_t p = 0; p < m_header->properties.count; p++) {
+      const UcdDbProperty& prop = properties[p];
+      if (badString(prop.name) ||
+          uint64_t(prop.firstValue) + prop.numValues > m_header->values.count)
+        fail();
+      for (uint32_t v = prop.firstValue; v < prop.firstValue + prop.numValues; v++) {
+        if (values[v].property != p)
+          fail();
+      }
+    }
+
+    for (uint32_t v = 0; v < m_header->values.count; v++) {
+      const UcdDbValue& value = values[v];
+      if (badString(value.name) || value.property >= m_header->properties.count ||
+          uint64_t(value.firstRange) + value.numRanges > m_header->ranges.count)
+        fail();
+    }
+
+    for (uint32_t a = 0; a < m_header->aliases.count; a++) {
+      const UcdDbAlias& alias = aliases[a];
+      if (badString(alias.name))
+        fail();
+      if (alias.scope == UCDDB_NONE) {
+        if (alias.target >= m_header->properties.count)
+          fail();
+      }
+      else if (alias.scope >= m_header->properties.count ||
+               alias.target >= m_header->values.count ||
+               values[alias.target].property != alias.scope)
+        fail();
+    }
+  }
+
+  size_t
+  UcdDatabase::findAlias(uint32_t scope, const char *name) const
+  {
+    size_t lo = 0;
+    size_t hi = m_header->aliases.count;
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      const UcdDbAlias& a = m_aliases[mid];
+      int cmp = (a.scope != scope) ? ((a.scope < scope) ? -1 : 1)
+        : strcmp(string(a.name), name);
+      if (cmp == 0)
+        return a.target;
+      if (cmp < 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    return npos;
+  }
+
+  size_t
+  UcdDatabase::findProperty(const char *name) const
+  {
+    size_t lo = 0;
+    size_t hi = numProperties();
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      int cmp = strcmp(propertyName(mid), name);
+      if (cmp == 0)
+        return mid;
+      if (cmp < 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    return findAlias(UCDDB_NONE, name);
+  }
+
+  size_t
+  UcdDatabase::findValue(size_t p, const char *name) const
+  {
+    size_t lo = m_properties[p].firstValue;
+    size_t hi = lo + m_properties[p].numValues;
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      int cmp = strcmp(valueName(mid), name);
+      if (cmp == 0)
+        return mid;
+      if (cmp < 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    return findAlias(p, name);
+  }
+
+  size_t
+  UcdDatabase::lookup(size_t p, CodePoint_t cp) const
+  {
+    // The values of a property partition (part of) the code space, so at
+    // most one of them contains cp.
+    for (size_t i = 0; i < numValues(p); i++) {
+      size_t v = value(p, i);
+      if (ranges(v).contains(cp))
+        return v;
+    }
+    return npos;
+  }
+}
@@ -0,0 +1,124 @@
+#ifndef UCDDATABASE_H
+#define UCDDATABASE_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <string>
+
+#include "CodePointRangeTable.h"
+#include "MappedFile.h"
+#include "UcdDatabaseFormat.h"
+
+namespace libucd {
+  /// @brief A binary property database (see UcdDatabaseFormat.h), mapped
+  /// into memory and queried in place.
+  ///
+  /// Opening a database maps the file and checks that its header and
+  /// table references are consistent; nothing is copied or decoded, so
+  /// this takes time proportional to the number of properties and
+  /// values, not to the number of ranges. The mapping is shared with
+  /// any other process that has the same file open.
+  ///
+  /// Properties and values are identified by index. Value indices are
+  /// global to the database; value(p, i) gives the index of the i'th
+  /// value of property p.
+  class UcdDatabase
+  {
+      MappedFile m_file;
+      const UcdDbHeader *m_header;
+      const UcdDbProperty *m_properties;
+      const UcdDbValue *m_values;
+      const UcdDbAlias *m_aliases;
+      const CodePointRange *m_ranges;
+
+      /// @brief Throw std::runtime_error unless the file is a database
+      /// this reader understands and every reference in it is in range.
+      void validate() const;
+
+      const char *string(uint32_t offset) const
+      { return m_file.data() + offset; }
+
+      /// @brief Index of the target of alias @p name in @p scope, or npos.
+      size_t findAlias(uint32_t scope, const char *name) const;
+
+    public:
+      static const size_t npos = size_t(-1);
+
+      /// @brief Map and check the database at @p path. Throws
+      /// std::runtime_error if it cannot be read or is not valid.
+      explicit UcdDatabase(const std::string& path);
+
+      /// @brief The Unicode version recorded by the writer, or "".
+      const char *unicodeVersion() const
+      { return string(m_header->unicodeVersion); }
+
+      size_t numProperties() const { return m_header->properties.count; }
+      const char *propertyName(size_t p) const
+      { return string(m_properties[p].name); }
+
+      /// @brief Index of the property named or aliased @p name, or npos.
+      size_t findProperty(const char *name) const;
+
+      size_t numValues(size_t p) const { return m_properties[p].numValues; }
+      size_t value(size_t p, size_t i) const
+      { return m_properties[p].firstValue + i; }
+
+      const char *valueName(size_t v) const
+      { return string(m_values[v].name); }
+      size_t valueProperty(size_t v) const { return m_values[v].property; }
+
+      /// @brief Index of the value of property @p p that is named or
+      /// aliased @p name, or npos.
+      size_t findValue(size_t p, const char *name) const;
+
+      /// @brief The code points that have value @p v.
+      CodePointRangeTable ranges(size_t v) const
+      { return CodePointRangeTable(m_ranges + m_values[v].firstRange,
+                                   m_values[v].numRanges); }
+
+      /// @brief Index of the value of property @p p that @p cp has, or
+      /// npos if @p cp is in none of its values' ranges.
+      size_t lookup(size_t p, CodePoint_t cp) const;
+
+      /// @brief Size of the mapped file in bytes.
+      size_t byteSize() const { return m_file.size(); }
+  };
+}
+
+#endif // UCDDATABASE_H
@@ -0,0 +1,124 @@
+#ifndef UCDDATABASEFORMAT_H
+#define UCDDATABASEFORMAT_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <stdint.h>
+
+/// @file
+/// @brief Layout of the binary property database written by
+/// compile-props --binary and read by UcdDatabase.
+///
+/// The file is a header followed by five tables. Every reference
+/// between them is an index or a byte offset from the start of the file,
+/// so the file can be mapped at any address and used in place. All
+/// fields are 32-bit words in the byte order of the machine that wrote
+/// the file; the header records it so that a reader on a machine of the
+/// other byte order rejects the file rather than misreading it.
+///
+///   properties  UcdDbProperty[], sorted by name
+///   values      UcdDbValue[]; the values of each property are
+///               contiguous and sorted by name
+///   aliases     UcdDbAlias[], sorted by (scope, name)
+///   ranges      (min, max) pairs of code points; the ranges of each
+///               value are contiguous, ascending, disjoint and
+///               non-abutting
+///   strings     NUL-terminated UTF-8 names
+///
+/// Readers accept files whose formatVersion equals
+/// UCDDB_FORMAT_VERSION; any change to the layout bumps it.
+
+namespace libucd {
+  static const char UCDDB_MAGIC[8] = { 'U', 'C', 'D', 'D', 'B', '\r', '\n', '\032' };
+  static const uint32_t UCDDB_FORMAT_VERSION = 1;
+  static const uint32_t UCDDB_BYTE_ORDER = 0x01020304U;
+
+  /// @brief Marks the absence of an index.
+  static const uint32_t UCDDB_NONE = 0xffffffffU;
+
+  struct UcdDbTable {
+    uint32_t offset;
+    uint32_t count;
+  };
+
+  struct UcdDbHeader {
+    char magic[8];
+    uint32_t formatVersion;
+    uint32_t byteOrder;
+    uint32_t fileSize;
+
+    /// @brief String offset of the Unicode version the data describes,
+    /// which may be empty.
+    uint32_t unicodeVersion;
+
+    UcdDbTable properties;
+    UcdDbTable values;
+    UcdDbTable aliases;
+    UcdDbTable ranges;
+
+    /// @brief The string pool. Its count is in bytes.
+    UcdDbTable strings;
+  };
+
+  struct UcdDbProperty {
+    uint32_t name;
+    uint32_t firstValue;
+    uint32_t numValues;
+  };
+
+  struct UcdDbValue {
+    uint32_t name;
+    uint32_t property;
+    uint32_t firstRange;
+    uint32_t numRanges;
+  };
+
+  /// @brief An alternative name for a property or a property value.
+  ///
+  /// Property aliases have scope UCDDB_NONE and name the property with
+  /// index @em target. Value aliases have as their scope the index of
+  /// the property, and name the value with index @em target.
+  struct UcdDbAlias {
+    uint32_t scope;
+    uint32_t name;
+    uint32_t target;
+  };
+}
+
+#endif // UCDDATABASEFORMAT_H
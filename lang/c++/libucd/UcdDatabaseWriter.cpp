@@ -0,0 +1,225 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <string.h>
+#include <vector>
+
+#include "UcdDatabaseFormat.h"
+#include "UcdDatabaseWriter.h"
+
+namespace libucd {
+  namespace {
+    /// @brief Deduplicating pool of NUL-terminated strings. Offsets are
+    /// relative to the start of the pool until the pool is placed.
+    class StringPool {
+        std::string m_data;
+        std::map<std::string, uint32_t> m_offsets;
+
+      public:
+        uint32_t add(const std::string& s)
+        {
+          auto it = m_offsets.find(s);
+          if (it != m_offsets.end())
+            return it->second;
+
+          uint32_t offset = m_data.size();
+          m_data.append(s.c_str(), s.size() + 1);
+          m_offsets.insert(std::make_pair(s, offset));
+          return offset;
+        }
+
+        const std::string& data() const { return m_data; }
+    };
+
+    struct AliasEntry {
+      uint32_t scope;
+      std::string name;
+      uint32_t target;
+
+      bool operator<(const AliasEntry& that) const
+      {
+        if (scope != that.scope)
+          return scope < that.scope;
+        return name < that.name;
+      }
+    };
+
+    template<class T>
+    void
+    append(std::string& out, const T& x)
+    {
+      out.append(reinterpret_cast<const char *>(&x), sizeof(x));
+    }
+
+    UcdDbTable
+    table(uint32_t& offset, size_t count, size_t elementSize)
+    {
+      UcdDbTable t;
+      t.offset = offset;
+      t.count = count;
+      offset += count * elementSize;
+      return t;
+    }
+  }
+
+  std::string
+  UcdDatabaseWriter::serialize() const
+  {
+    StringPool strings;
+    std::vector<UcdDbProperty> properties;
+    std::vector<UcdDbValue> values;
+    std::vector<CodePointRange> ranges;
+
+    // Index of each property, and of each (property, value).
+    std::map<std::string, uint32_t> propertyIndex;
+    std::map<std::pair<std::string, std::string>, uint32_t> valueIndex;
+
+    uint32_t unicodeVersion = strings.add(m_unicodeVersion);
+
+    for (auto p = m_properties.begin(); p != m_properties.end(); p++) {
+      UcdDbProperty prop;
+      prop.name = strings.add(p->first);
+      prop.firstValue = values.size();
+      prop.numValues = p->second.size();
+      propertyIndex[p->first] = properties.size();
+
+      for (auto v = p->second.begin(); v != p->second.end(); v++) {
+        UcdDbValue value;
+        value.name = strings.add(v->first);
+        value.property = properties.size();
+        value.firstRange = ranges.size();
+        value.numRanges = v->second.size();
+        valueIndex[std::make_pair(p->first, v->first)] = values.size();
+
+        values.push_back(value);
+        ranges.insert(ranges.end(), v->second.begin(), v->second.end());
+      }
+
+      properties.push_back(prop);
+    }
+
+    std::vector<AliasEntry> aliases;
+    for (auto a = m_propertyAliases.begin(); a != m_propertyAliases.end(); a++) {
+      auto p = propertyIndex.find(a->first);
+      if (p == propertyIndex.end() || a->first == a->second)
+        continue;
+      AliasEntry e = { UCDDB_NONE, a->second, p->second };
+      aliases.push_back(e);
+    }
+    for (auto a = m_valueAliases.begin(); a != m_valueAliases.end(); a++) {
+      auto v = valueIndex.find(std::make_pair(std::get<0>(*a), std::get<1>(*a)));
+      if (v == valueIndex.end() || std::get<1>(*a) == std::get<2>(*a))
+        continue;
+      AliasEntry e = { values[v->second].property, std::get<2>(*a), v->second };
+      aliases.push_back(e);
+    }
+
+    // Where one name is given to two targets in the same scope, the
+    // first one added wins.
+    std::stable_sort(aliases.begin(), aliases.end());
+    aliases.erase(std::unique(aliases.begin(), aliases.end(),
+                              [](const AliasEntry& a, const AliasEntry& b) {
+                                return !(a < b) && !(b < a);
+                              }),
+                  aliases.end());
+
+    std::vector<UcdDbAlias> aliasRecords;
+    for (size_t i = 0; i < aliases.size(); i++) {
+      UcdDbAlias a = { aliases[i].scope, strings.add(aliases[i].name),
+                       aliases[i].target };
+      aliasRecords.push_back(a);
+    }
+
+    // Lay out the tables, then make string offsets file-relative.
+    UcdDbHeader header;
+    memcpy(header.magic, UCDDB_MAGIC, sizeof(header.magic));
+    header.formatVersion = UCDDB_FORMAT_VERSION;
+    header.byteOrder = UCDDB_BYTE_ORDER;
+
+    uint32_t offset = sizeof(UcdDbHeader);
+    header.properties = table(offset, properties.size(), sizeof(UcdDbProperty));
+    header.values = table(offset, values.size(), sizeof(UcdDbValue));
+    header.aliases = table(offset, aliasRecords.size(), sizeof(UcdDbAlias));
+    header.ranges = table(offset, ranges.size(), sizeof(CodePointRange));
+    header.strings = table(offset, strings.data().size(), 1);
+    header.fileSize = offset;
+
+    uint32_t base = header.strings.offset;
+    header.unicodeVersion = base + unicodeVersion;
+    for (size_t i = 0; i < properties.size(); i++)
+      properties[i].name += base;
+    for (size_t i = 0; i < values.size(); i++)
+      values[i].name += base;
+    for (size_t i = 0; i < aliasRecords.size(); i++)
+      aliasRecords[i].name += base;
+
+    std::string out;
+    out.reserve(header.fileSize);
+    append(out, header);
+    for (size_t i = 0; i < properties.size(); i++)
+      append(out, properties[i]);
+    for (size_t i = 0; i < values.size(); i++)
+      append(out, values[i]);
+    for (size_t i = 0; i < aliasRecords.size(); i++)
+      append(out, aliasRecords[i]);
+    for (size_t i = 0; i < ranges.size(); i++) {
+      append(out, ranges[i].min());
+      append(out, ranges[i].max());
+    }
+    out += strings.data();
+
+    return out;
+  }
+
+  void
+  UcdDatabaseWriter::write(const std::string& path) const
+  {
+    std::string data = serialize();
+
+    std::ofstream os(path.c_str(), std::ios::binary);
+    if (!os)
+      throw std::runtime_error(path + ": cannot create");
+    os.write(data.data(), data.size());
+    os.close();
+    if (!os)
+      throw std::runtime_error(path + ": write error");
+  }
+}
@@ -0,0 +1,95 @@
+#ifndef UCDDATABASEWRITER_H
+#define UCDDATABASEWRITER_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "CodePointSet.h"
+
+namespace libucd {
+  /// @brief Builds a binary property database (see UcdDatabaseFormat.h).
+  ///
+  /// Properties, values and aliases may be added in any order; they are
+  /// sorted when the database is serialized. Aliases that name a
+  /// property or value that was never added are dropped, so the same
+  /// alias files can be used whatever subset of properties is written.
+  class UcdDatabaseWriter
+  {
+    public:
+      typedef std::map<std::string, CodePointSet> ValueMap;
+
+    private:
+      std::string m_unicodeVersion;
+      std::map<std::string, ValueMap> m_properties;
+
+      // (property, alias) and (property, value, alias)
+      std::set<std::pair<std::string, std::string> > m_propertyAliases;
+      std::set<std::tuple<std::string, std::string, std::string> > m_valueAliases;
+
+    public:
+      void setUnicodeVersion(const std::string& version)
+      { m_unicodeVersion = version; }
+
+      /// @brief Add property @p name, whose values are the keys of
+      /// @p values. Adding a property a second time replaces it.
+      void addProperty(const std::string& name, const ValueMap& values)
+      { m_properties[name] = values; }
+
+      void addPropertyAlias(const std::string& property, const std::string& alias)
+      { m_propertyAliases.insert(std::make_pair(property, alias)); }
+
+      void addValueAlias(const std::string& property, const std::string& value,
+                         const std::string& alias)
+      { m_valueAliases.insert(std::make_tuple(property, value, alias)); }
+
+      /// @brief Return the database file contents.
+      std::string serialize() const;
+
+      /// @brief Write the database to @p path. Throws std::runtime_error
+      /// on failure.
+      void write(const std::string& path) const;
+  };
+}
+
+#endif // UCDDATABASEWRITER_H
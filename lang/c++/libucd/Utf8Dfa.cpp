@@ -0,0 +1,100 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include "Utf8Dfa.h"
+
+namespace libucd {
+  // Classes: 0 ASCII; 1, 9 and 7 the continuation bytes 80..8F, 90..9F
+  // and A0..BF; 2 the lead bytes of two-byte sequences; 10, 3 and 4 the
+  // three-byte leads E0, E1..EC/EE..EF and ED; 11, 6 and 5 the four-byte
+  // leads F0, F1..F3 and F4; 8 the bytes that never appear.
+  const uint8_t utf8_dfa_class[256] = {
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1, 9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
+    7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7, 7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
+    8,8,2,2,2,2,2,2,2,2,2,2,2,2,2,2, 2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+    10,3,3,3,3,3,3,3,3,3,3,3,3,4,3,3, 11,6,6,6,5,8,8,8,8,8,8,8,8,8,8,8
+  };
+
+  // States: 0 accept; 12 reject; 24, 36 and 84 one, two and three
+  // continuation bytes to go; 48 after E0, 60 after ED, 72 after F0 and
+  // 96 after F4, where the next byte is restricted.
+  const uint8_t utf8_dfa_transition[108] = {
+     0,12,24,36,60,96,84,12,12,12,48,72,  // accept
+    12,12,12,12,12,12,12,12,12,12,12,12,  // reject
+    12, 0,12,12,12,12,12, 0,12, 0,12,12,  // 1 to go
+    12,24,12,12,12,12,12,24,12,24,12,12,  // 2 to go
+    12,12,12,12,12,12,12,24,12,12,12,12,  // E0: A0..BF
+    12,24,12,12,12,12,12,12,12,24,12,12,  // ED: 80..9F
+    12,12,12,12,12,12,12,36,12,36,12,12,  // F0: 90..BF
+    12,36,12,12,12,12,12,36,12,36,12,12,  // 3 to go
+    12,36,12,12,12,12,12,12,12,12,12,12   // F4: 80..8F
+  };
+
+  Utf8Error
+  utf8_dfa_error(uint32_t state, unsigned char byte)
+  {
+    if (state == UTF8_DFA_ACCEPT) {
+      if (byte < 0xc0)
+        return UTF8_UNEXPECTED_CONTINUATION;
+      else if (byte < 0xc2)
+        return UTF8_OVERLONG;
+      else if (byte < 0xf8)
+        return UTF8_TOO_LARGE;
+      return UTF8_INVALID_BYTE;
+    }
+
+    if ((byte & 0xc0U) != 0x80U)
+      return UTF8_INCOMPLETE;
+
+    // A continuation byte is only refused right after a lead byte that
+    // restricts it.
+    switch (state) {
+    case 48:
+    case 72:
+      return UTF8_OVERLONG;
+    case 60:
+      return UTF8_SURROGATE;
+    default:
+      return UTF8_TOO_LARGE;
+    }
+  }
+}
@@ -0,0 +1,83 @@
+#ifndef UTF8DFA_H
+#define UTF8DFA_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <stdint.h>
+
+#include "utf8.h"
+
+namespace libucd {
+  // The UTF-8 decoding automaton shared by utf8_decode_checked() and
+  // Utf8StreamDecoder.
+  //
+  // This is Bjoern Hoehrmann's DFA ("Flexible and Economical UTF-8
+  // Decoder"). Each byte maps to one of 12 classes, chosen so that the
+  // class also gives the mask for the payload bits of a lead byte, and
+  // each state, premultiplied by the number of classes, indexes a row of
+  // the transition table. The automaton accepts exactly the well-formed
+  // sequences of Unicode Table 3-7.
+
+  static const uint32_t UTF8_DFA_ACCEPT = 0;
+  static const uint32_t UTF8_DFA_REJECT = 12;
+
+  /// @brief Class of each byte value.
+  extern const uint8_t utf8_dfa_class[256];
+
+  /// @brief Next state, indexed by state + class.
+  extern const uint8_t utf8_dfa_transition[108];
+
+  /// @brief Feed @p byte to the automaton in @p state, accumulating the
+  /// code point in @p cp. Returns the new state; @p cp holds a complete
+  /// code point when that is UTF8_DFA_ACCEPT.
+  static inline uint32_t
+  utf8_dfa_step(uint32_t state, CodePoint_t& cp, unsigned char byte)
+  {
+    uint32_t type = utf8_dfa_class[byte];
+    cp = (state != UTF8_DFA_ACCEPT) ? ((byte & 0x3fU) | (cp << 6))
+                                    : ((0xffU >> type) & byte);
+    return utf8_dfa_transition[state + type];
+  }
+
+  /// @brief Why @p byte took the automaton from @p state to
+  /// UTF8_DFA_REJECT.
+  Utf8Error utf8_dfa_error(uint32_t state, unsigned char byte);
+}
+
+#endif // UTF8DFA_H
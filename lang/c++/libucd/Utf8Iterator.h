@@ -0,0 +1,218 @@
+#ifndef UTF8ITERATOR_H
+#define UTF8ITERATOR_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <cstring>
+#include <iterator>
+
+#include "CodePoint.h"
+
+namespace libucd {
+  /// @brief A bidirectional iterator over the code points of a UTF-8
+  /// encoded byte range [begin, end).
+  ///
+  /// Decoding is done inline and nothing is allocated. The code point at
+  /// the current position is decoded when the iterator arrives there,
+  /// so dereferencing is free.
+  ///
+  /// A byte that does not start a well-formed sequence yields
+  /// CODEPOINT_EOF and the iterator advances past that one byte only, so
+  /// iteration always terminates and resynchronises at the next lead
+  /// byte. Sequences are accepted as by utf8_decode(), except that a
+  /// continuation byte or a 5- or 6-byte lead byte is never taken as the
+  /// start of a sequence; that is what makes stepping backwards agree
+  /// with stepping forwards.
+  class Utf8Iterator
+  {
+    public:
+      typedef std::bidirectional_iterator_tag iterator_category;
+      typedef CodePoint_t value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef const CodePoint_t *pointer;
+      typedef CodePoint_t reference;
+
+    private:
+      const char *m_begin;
+      const char *m_end;
+      const char *m_pos;
+      const char *m_next;
+      CodePoint_t m_value;
+
+      /// @brief Decode the sequence at @p s, which is before @p end, and
+      /// set @p *next to the byte following it.
+      static CodePoint_t decode(const char *s, const char *end,
+                                const char **next)
+      {
+        unsigned char b0 = *s;
+        *next = s + 1;
+        if (b0 < 0x80U)
+          return b0;
+
+        std::ptrdiff_t nBytes =
+          (b0 < 0xc0U) ? 0 : (b0 < 0xe0U) ? 2 : (b0 < 0xf0U) ? 3 : (b0 < 0xf8U) ? 4 : 0;
+        if ((nBytes == 0) || ((end - s) < nBytes))
+          return CODEPOINT_EOF;
+
+        CodePoint_t c = b0 & (0x7fU >> nBytes);
+        for (std::ptrdiff_t i = 1; i < nBytes; i++) {
+          unsigned char b = s[i];
+          if ((b & 0xc0U) != 0x80U)
+            return CODEPOINT_EOF;
+          c = (c << 6) | (b & 0x3fU);
+        }
+
+        if (c > CODEPOINT_MAX)
+          return CODEPOINT_EOF;
+
+        *next = s + nBytes;
+        return c;
+      }
+
+      void load()
+      {
+        if (m_pos != m_end)
+          m_value = decode(m_pos, m_end, &m_next);
+      }
+
+    public:
+      Utf8Iterator()
+        : m_begin(0), m_end(0), m_pos(0), m_next(0), m_value(CODEPOINT_EOF)
+      { }
+
+      /// @brief An iterator at @p pos within [@p begin, @p end). @p pos
+      /// should be a code point boundary, such as @p begin or @p end.
+      Utf8Iterator(const char *pos, const char *begin, const char *end)
+        : m_begin(begin), m_end(end), m_pos(pos), m_next(pos),
+          m_value(CODEPOINT_EOF)
+      {
+        load();
+      }
+
+      /// @brief The address of the first byte of the current code point.
+      const char *base() const { return m_pos; }
+
+      CodePoint_t operator*() const { return m_value; }
+
+      Utf8Iterator& operator++()
+      {
+        m_pos = m_next;
+        load();
+        return *this;
+      }
+
+      Utf8Iterator operator++(int)
+      {
+        Utf8Iterator old = *this;
+        ++(*this);
+        return old;
+      }
+
+      Utf8Iterator& operator--()
+      {
+        // Back up over at most three continuation bytes to a lead byte,
+        // and take it if its sequence ends exactly here. Otherwise the
+        // previous byte was malformed and is a code point on its own.
+        const char *lead = m_pos - 1;
+        for (int i = 0; i < 3 && lead != m_begin && ((*lead & 0xc0) == 0x80); i++)
+          lead--;
+
+        m_value = decode(lead, m_end, &m_next);
+        if (m_next != m_pos) {
+          lead = m_pos - 1;
+          m_value = decode(lead, m_end, &m_next);
+        }
+        m_pos = lead;
+        return *this;
+      }
+
+      Utf8Iterator operator--(int)
+      {
+        Utf8Iterator old = *this;
+        --(*this);
+        return old;
+      }
+
+      bool operator==(const Utf8Iterator& that) const
+      { return m_pos == that.m_pos; }
+      bool operator!=(const Utf8Iterator& that) const
+      { return m_pos != that.m_pos; }
+  };
+
+  /// @brief The code points of a UTF-8 byte range, for use with
+  /// range-based for and the standard algorithms.
+  class Utf8Range
+  {
+      const char *m_begin;
+      const char *m_end;
+
+    public:
+      typedef Utf8Iterator iterator;
+      typedef Utf8Iterator const_iterator;
+      typedef std::reverse_iterator<Utf8Iterator> reverse_iterator;
+
+      Utf8Range(const char *begin, const char *end)
+        : m_begin(begin), m_end(end)
+      { }
+
+      Utf8Iterator begin() const { return Utf8Iterator(m_begin, m_begin, m_end); }
+      Utf8Iterator end() const { return Utf8Iterator(m_end, m_begin, m_end); }
+
+      reverse_iterator rbegin() const { return reverse_iterator(end()); }
+      reverse_iterator rend() const { return reverse_iterator(begin()); }
+
+      bool empty() const { return m_begin == m_end; }
+  };
+
+  /// @brief The code points of the @p len bytes at @p s.
+  inline Utf8Range
+  utf8_range(const char *s, size_t len)
+  {
+    return Utf8Range(s, s + len);
+  }
+
+  /// @brief The code points of the NUL-terminated string @p s.
+  inline Utf8Range
+  utf8_range(const char *s)
+  {
+    return Utf8Range(s, s + std::strlen(s));
+  }
+}
+
+#endif // UTF8ITERATOR_H
@@ -0,0 +1,322 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <map>
+#include <stdexcept>
+#include <string.h>
+#include <utility>
+
+#include "Utf8Matcher.h"
+
+namespace libucd {
+  namespace {
+    struct ByteRange {
+      uint8_t lo;
+      uint8_t hi;
+
+      bool operator==(const ByteRange& that) const
+      { return lo == that.lo && hi == that.hi; }
+    };
+
+    /// @brief The byte ranges matching the encodings of a range of code
+    /// points whose encodings have the same length and differ only in
+    /// the bytes where the range spans whole blocks.
+    struct Utf8Sequence {
+      ByteRange bytes[4];
+      unsigned length;
+    };
+
+    unsigned
+    encode(CodePoint_t cp, uint8_t *b)
+    {
+      if (cp < 0x80) {
+        b[0] = uint8_t(cp);
+        return 1;
+      }
+      if (cp < 0x800) {
+        b[0] = uint8_t(0xc0 | (cp >> 6));
+        b[1] = uint8_t(0x80 | (cp & 0x3f));
+        return 2;
+      }
+      if (cp < 0x10000) {
+        b[0] = uint8_t(0xe0 | (cp >> 12));
+        b[1] = uint8_t(0x80 | ((cp >> 6) & 0x3f));
+        b[2] = uint8_t(0x80 | (cp & 0x3f));
+        return 3;
+      }
+      b[0] = uint8_t(0xf0 | (cp >> 18));
+      b[1] = uint8_t(0x80 | ((cp >> 12) & 0x3f));
+      b[2] = uint8_t(0x80 | ((cp >> 6) & 0x3f));
+      b[3] = uint8_t(0x80 | (cp & 0x3f));
+      return 4;
+    }
+
+    /// @brief Append the sequences matching [lo, hi] to @p out, in
+    /// ascending order.
+    ///
+    /// The range is split until both ends encode to the same length and
+    /// each byte position either spans whole blocks of continuation
+    /// bytes or has a fixed prefix above it, so the range is exactly
+    /// the product of the per-byte ranges between the encodings of its
+    /// ends.
+    void
+    appendSequences(CodePoint_t lo, CodePoint_t hi, std::vector<Utf8Sequence>& out)
+    {
+      static const CodePoint_t lengthLimits[] = { 0x7f, 0x7ff, 0xffff };
+      std::vector<std::pair<CodePoint_t, CodePoint_t> > stack;
+
+      // The upper part is pushed first, so the lower one is split next.
+      auto split = [&](CodePoint_t s, CodePoint_t mid, CodePoint_t e) {
+        stack.push_back({ mid + 1, e });
+        stack.push_back({ s, mid });
+      };
+
+      stack.push_back({ lo, std::min(hi, CODEPOINT_MAX) });
+      while (!stack.empty()) {
+        CodePoint_t s = stack.back().first;
+        CodePoint_t e = stack.back().second;
+        stack.pop_back();
+        if (s > e)
+          continue;
+
+        if (s <= 0xdfff && e >= 0xd800) {
+          // Surrogates have no well-formed encoding. Either part may be
+          // empty, and is then dropped above.
+          stack.push_back({ 0xe000, e });
+          stack.push_back({ s, 0xd7ff });
+          continue;
+        }
+
+        bool didSplit = false;
+        for (size_t i = 0; i < 3 && !didSplit; i++) {
+          if (s <= lengthLimits[i] && e > lengthLimits[i]) {
+            split(s, lengthLimits[i], e);
+            didSplit = true;
+          }
+        }
+
+        for (unsigned i = 1; i < 4 && !didSplit; i++) {
+          CodePoint_t m = (CodePoint_t(1) << (6 * i)) - 1;
+          if ((s & ~m) == (e & ~m))
+            continue;
+          if ((s & m) != 0) {
+            split(s, s | m, e);
+            didSplit = true;
+          }
+          else if ((e & m) != m) {
+            split(s, (e & ~m) - 1, e);
+            didSplit = true;
+          }
+        }
+
+        if (didSplit)
+          continue;
+
+        uint8_t sb[4], eb[4];
+        Utf8Sequence seq;
+        seq.length = encode(s, sb);
+        encode(e, eb);
+        for (unsigned i = 0; i < seq.length; i++)
+          seq.bytes[i] = ByteRange{ sb[i], eb[i] };
+        out.push_back(seq);
+      }
+    }
+
+    struct TrieNode {
+      std::vector<std::pair<ByteRange, size_t> > edges;
+    };
+  }
+
+  const uint16_t Utf8Matcher::DEAD;
+  const uint16_t Utf8Matcher::MATCH;
+
+  Utf8Matcher::Utf8Matcher(const CodePointSet& set)
+  {
+    std::vector<Utf8Sequence> sequences;
+    for (auto it = set.begin(); it != set.end(); ++it)
+      appendSequences(it->min(), it->max(), sequences);
+
+    // Build the byte-range trie. The sequences are ascending and
+    // disjoint, and each splits at the same block boundaries as any
+    // neighbour sharing a prefix with it, so at every node a new edge
+    // either repeats the last one or lies wholly above it.
+    std::vector<TrieNode> trie(1);
+    for (size_t i = 0; i < sequences.size(); i++) {
+      const Utf8Sequence& seq = sequences[i];
+      size_t node = 0;
+      for (unsigned k = 0; k < seq.length; k++) {
+        std::vector<std::pair<ByteRange, size_t> >& edges = trie[node].edges;
+        if (!edges.empty() && edges.back().first == seq.bytes[k]) {
+          node = edges.back().second;
+          continue;
+        }
+        if (!edges.empty() && edges.back().first.hi >= seq.bytes[k].lo)
+          throw std::logic_error("Utf8Matcher: overlapping UTF-8 sequences");
+        edges.push_back({ seq.bytes[k], trie.size() });
+        node = trie.size();
+        trie.push_back(TrieNode());
+      }
+    }
+
+    // Share identical subtrees. Children always follow their parent in
+    // the trie, so walking backwards numbers every child first. Each
+    // state is keyed by its edges: lo, hi and target state.
+    std::map<std::vector<uint32_t>, uint32_t> stateIds;
+    std::vector<std::vector<uint32_t> > stateEdges(2);
+    std::vector<uint32_t> trieState(trie.size());
+
+    for (size_t n = trie.size(); n-- > 0; ) {
+      const std::vector<std::pair<ByteRange, size_t> >& edges = trie[n].edges;
+      if (edges.empty()) {
+        trieState[n] = (n == 0) ? DEAD : MATCH;
+        continue;
+      }
+
+      std::vector<uint32_t> key;
+      for (size_t e = 0; e < edges.size(); e++) {
+        key.push_back(edges[e].first.lo);
+        key.push_back(edges[e].first.hi);
+        key.push_back(trieState[edges[e].second]);
+      }
+
+      auto ins = stateIds.insert({ key, uint32_t(stateEdges.size()) });
+      if (ins.second)
+        stateEdges.push_back(key);
+      trieState[n] = ins.first->second;
+    }
+
+    // A state whose edges all lead to MATCH consumes the last byte of a
+    // code point, which is a continuation byte, so it is stored as a
+    // mask of the continuation bytes it accepts instead of as a row of
+    // the table. Those states are numbered last.
+    std::vector<uint32_t> renumber(stateEdges.size());
+    std::vector<size_t> leaves;
+    renumber[DEAD] = DEAD;
+    renumber[MATCH] = MATCH;
+    uint32_t numRows = 2;
+    for (size_t s = 2; s < stateEdges.size(); s++) {
+      const std::vector<uint32_t>& key = stateEdges[s];
+      bool leaf = true;
+      for (size_t e = 0; e < key.size() && leaf; e += 3)
+        leaf = key[e] >= 0x80 && key[e + 1] <= 0xbf && key[e + 2] == MATCH;
+      if (leaf)
+        leaves.push_back(s);
+      else
+        renumber[s] = numRows++;
+    }
+    for (size_t l = 0; l < leaves.size(); l++)
+      renumber[leaves[l]] = uint32_t(numRows + l);
+
+    if (stateEdges.size() > 65536)
+      throw std::length_error("Utf8Matcher: too many states");
+    m_numStates = unsigned(stateEdges.size());
+    m_firstLeaf = uint16_t(numRows);
+    uint32_t start = renumber[trieState[0]];
+
+    m_leaves.assign(leaves.size(), 0);
+    for (size_t l = 0; l < leaves.size(); l++) {
+      const std::vector<uint32_t>& key = stateEdges[leaves[l]];
+      for (size_t e = 0; e < key.size(); e += 3) {
+        for (uint32_t b = key[e]; b <= key[e + 1]; b++)
+          m_leaves[l] |= uint64_t(1) << (b - 0x80);
+      }
+    }
+
+    // Bytes fall into the same class unless some edge of a table row
+    // starts or ends between them.
+    bool boundary[257];
+    memset(boundary, 0, sizeof(boundary));
+    for (size_t s = 2; s < stateEdges.size(); s++) {
+      const std::vector<uint32_t>& key = stateEdges[s];
+      if (renumber[s] >= numRows)
+        continue;
+      for (size_t e = 0; e < key.size(); e += 3) {
+        boundary[key[e]] = true;
+        boundary[key[e + 1] + 1] = true;
+      }
+    }
+
+    m_numClasses = 0;
+    for (unsigned b = 0; b < 256; b++) {
+      if (boundary[b] && b > 0)
+        m_numClasses++;
+      m_classes[b] = uint8_t(m_numClasses);
+    }
+    m_numClasses++;
+
+    m_next.assign(size_t(numRows) * m_numClasses, DEAD);
+    for (size_t s = 2; s < stateEdges.size(); s++) {
+      const std::vector<uint32_t>& key = stateEdges[s];
+      if (renumber[s] >= numRows)
+        continue;
+      uint16_t *row = &m_next[renumber[s] * m_numClasses];
+      for (size_t e = 0; e < key.size(); e += 3) {
+        for (unsigned c = m_classes[key[e]]; c <= m_classes[key[e + 1]]; c++)
+          row[c] = uint16_t(renumber[key[e + 2]]);
+      }
+    }
+
+    for (unsigned b = 0; b < 256; b++)
+      m_first[b] = m_next[start * m_numClasses + m_classes[b]];
+  }
+
+  size_t
+  Utf8Matcher::span(const char *s, const char *end) const
+  {
+    const unsigned char *p = (const unsigned char *) s;
+    const unsigned char *e = (const unsigned char *) end;
+    const unsigned char *matched = p;
+    const uint16_t *next = m_next.data();
+
+    while (p < e) {
+      unsigned state = m_first[*p++];
+      while (state > MATCH && state < m_firstLeaf && p < e)
+        state = next[state * m_numClasses + m_classes[*p++]];
+      if (state >= m_firstLeaf) {
+        if (p == e || !leafAccepts(state, *p++))
+          break;
+        state = MATCH;
+      }
+      if (state != MATCH)
+        break;
+      matched = p;
+    }
+
+    return size_t(matched - (const unsigned char *) s);
+  }
+}
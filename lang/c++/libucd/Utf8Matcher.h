@@ -0,0 +1,142 @@
+#ifndef UTF8MATCHER_H
+#define UTF8MATCHER_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "CodePointSet.h"
+
+namespace libucd {
+  /// @brief A CodePointSet compiled into a deterministic automaton over
+  /// UTF-8 bytes, so that membership can be tested on encoded text
+  /// without decoding it.
+  ///
+  /// Each range of the set is split into sequences of byte ranges, one
+  /// range per byte of the encoding (e.g. U+0800..U+FFFF becomes
+  /// [E0][A0-BF][80-BF] and [E1-EF][80-BF][80-BF], less the surrogates),
+  /// as RE2 and Rust's regex-syntax do. The sequences are merged into a
+  /// byte-range trie whose identical subtrees are then shared, giving
+  /// the minimal automaton. Bytes that no state tells apart share an
+  /// equivalence class, so the transition table has one column per
+  /// class rather than per byte value. The states that take the last
+  /// byte of a code point, which are most of them, need no row: each is
+  /// a 64-bit mask of the continuation bytes it accepts. This keeps the
+  /// table small enough to stay in the L1 cache for sets the size of
+  /// real properties. The start state's row is also kept indexed by
+  /// byte value, so that the first byte of a code point, the only byte
+  /// of an ASCII one, needs no class lookup.
+  ///
+  /// Only well-formed UTF-8 is accepted: overlong forms, surrogates,
+  /// code points above U+10FFFF and truncated sequences never match.
+  /// Surrogate code points in the set are therefore ignored.
+  class Utf8Matcher
+  {
+      std::vector<uint16_t> m_next;   // [state * m_numClasses + class]
+      std::vector<uint64_t> m_leaves; // [state - m_firstLeaf]
+      uint16_t m_first[256];          // start state row, by byte value
+      uint8_t m_classes[256];
+      unsigned m_numClasses;
+      unsigned m_numStates;
+      uint16_t m_firstLeaf;
+
+      /// @brief True if leaf state @p state accepts @p byte.
+      bool leafAccepts(unsigned state, unsigned char byte) const
+      {
+        unsigned bit = byte ^ 0x80u;
+        return bit < 64 && ((m_leaves[state - m_firstLeaf] >> bit) & 1);
+      }
+
+    public:
+      /// @brief Sink state: no continuation can match.
+      static const uint16_t DEAD = 0;
+      /// @brief Entered on the last byte of a code point in the set.
+      static const uint16_t MATCH = 1;
+
+      /// @brief Compile @p set. Throws std::length_error in the unlikely
+      /// event that the automaton needs more than 65536 states.
+      explicit Utf8Matcher(const CodePointSet& set);
+
+      /// @brief Length of the code point at the start of [s, end) if it
+      /// is well-formed and in the set, otherwise 0.
+      size_t match(const char *s, const char *end) const
+      {
+        const unsigned char *p = (const unsigned char *) s;
+        const unsigned char *e = (const unsigned char *) end;
+        if (p == e)
+          return 0;
+
+        unsigned state = m_first[*p++];
+        for (;;) {
+          if (state >= m_firstLeaf) {
+            if (p == e || !leafAccepts(state, *p++))
+              return 0;
+            state = MATCH;
+          }
+          if (state <= MATCH)
+            return (state == MATCH) ? size_t((const char *) p - s) : 0;
+          if (p == e)
+            return 0;
+          state = m_next[state * m_numClasses + m_classes[*p++]];
+        }
+      }
+
+      /// @brief Length in bytes of the longest prefix of [s, end) that
+      /// consists of code points in the set.
+      size_t span(const char *s, const char *end) const;
+
+      /// @brief Number of states, including DEAD and MATCH.
+      unsigned numStates() const { return m_numStates; }
+
+      /// @brief Number of byte equivalence classes.
+      unsigned numClasses() const { return m_numClasses; }
+
+      /// @brief Bytes used by the transition and class tables.
+      size_t memoryUsage() const
+      {
+        return m_next.capacity() * sizeof(uint16_t)
+          + m_leaves.capacity() * sizeof(uint64_t)
+          + sizeof(m_first) + sizeof(m_classes);
+      }
+  };
+}
+
+#endif // UTF8MATCHER_H
@@ -0,0 +1,109 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+#include <assert.h>
+
+#include "Utf8OffsetIndex.h"
+#include "utf8.h"
+
+namespace libucd {
+  Utf8OffsetIndex::Utf8OffsetIndex(const char *s, size_t len, size_t stride)
+    : m_text(s), m_len(len), m_stride(stride), m_numCodePoints(0)
+  {
+    assert(stride > 0);
+
+    m_checkpoints.reserve(len / stride + 1);
+
+    size_t offset = 0;
+    while (offset < len) {
+      m_checkpoints.push_back(offset);
+      offset = skip(offset, stride);
+    }
+
+    m_numCodePoints = utf8_cpcount(s, len);
+  }
+
+  size_t
+  Utf8OffsetIndex::skip(size_t from, size_t n) const
+  {
+    // Any n bytes hold at most n code point starts, so whole runs of
+    // bytes can be counted with utf8_cpcount() without overshooting.
+    size_t offset = from;
+    while (n > 0 && offset < m_len) {
+      size_t chunk = std::min(n, m_len - offset);
+      n -= utf8_cpcount(m_text + offset, chunk);
+      offset += chunk;
+    }
+
+    // Step over the trailing continuation bytes of the last code point
+    // counted, to the start of the next one.
+    while (offset < m_len && ((m_text[offset] & 0xc0) == 0x80))
+      offset++;
+
+    return offset;
+  }
+
+  size_t
+  Utf8OffsetIndex::byteOffset(size_t cpIndex) const
+  {
+    assert(cpIndex <= m_numCodePoints);
+
+    if (cpIndex == m_numCodePoints)
+      return m_len;
+
+    size_t k = cpIndex / m_stride;
+    return skip(m_checkpoints[k], cpIndex - k * m_stride);
+  }
+
+  size_t
+  Utf8OffsetIndex::codePointIndex(size_t offset) const
+  {
+    assert(offset <= m_len);
+
+    // The last checkpoint at or before /offset/.
+    size_t k = std::upper_bound(m_checkpoints.begin(), m_checkpoints.end(),
+                                offset) - m_checkpoints.begin();
+    if (k == 0)
+      return 0;
+    k--;
+
+    size_t base = m_checkpoints[k];
+    return k * m_stride + utf8_cpcount(m_text + base, offset - base);
+  }
+}
@@ -0,0 +1,102 @@
+#ifndef UTF8OFFSETINDEX_H
+#define UTF8OFFSETINDEX_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <stddef.h>
+#include <vector>
+
+namespace libucd {
+  /// @brief Sparse map between code point indices and byte offsets in a
+  /// UTF-8 buffer.
+  ///
+  /// Converting a byte offset into a column, or a column back into a
+  /// byte offset, otherwise means rescanning from the start of the line.
+  /// The index records the byte offset of every @em stride'th code
+  /// point, so either conversion scans at most one stride from the
+  /// nearest checkpoint.
+  ///
+  /// Code points are counted as by utf8_cpcount(): every byte that is
+  /// not a continuation byte starts one. The index refers to the buffer
+  /// it was built from, which must outlive it.
+  class Utf8OffsetIndex
+  {
+      const char *m_text;
+      size_t m_len;
+      size_t m_stride;
+      size_t m_numCodePoints;
+
+      /// @brief m_checkpoints[k] is the byte offset of code point
+      /// k * m_stride.
+      std::vector<size_t> m_checkpoints;
+
+      /// @brief Return the offset of the code point @p n code points
+      /// after the one starting at byte offset @p from.
+      size_t skip(size_t from, size_t n) const;
+
+    public:
+      static const size_t DEFAULT_STRIDE = 64;
+
+      Utf8OffsetIndex(const char *s, size_t len,
+                      size_t stride = DEFAULT_STRIDE);
+
+      /// @brief Number of code points in the buffer.
+      size_t size() const { return m_numCodePoints; }
+
+      /// @brief Length of the buffer in bytes.
+      size_t byteLength() const { return m_len; }
+
+      size_t stride() const { return m_stride; }
+
+      /// @brief Byte offset of code point @p cpIndex, which must be at
+      /// most size(). The offset of size() is byteLength().
+      size_t byteOffset(size_t cpIndex) const;
+
+      /// @brief Number of code points that start before @p offset, which
+      /// must be at most byteLength(). At the start of a code point this
+      /// is that code point's index.
+      size_t codePointIndex(size_t offset) const;
+
+      /// @brief Bytes of heap storage used by the index.
+      size_t memoryUsage() const
+      { return m_checkpoints.capacity() * sizeof(size_t); }
+  };
+}
+
+#endif // UTF8OFFSETINDEX_H
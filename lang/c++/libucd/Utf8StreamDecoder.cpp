@@ -0,0 +1,162 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+
+#include "Utf8StreamDecoder.h"
+
+namespace libucd {
+  Utf8StreamDecoder::Utf8StreamDecoder(Utf8ErrorMode mode)
+    : m_mode(mode)
+  {
+    reset();
+  }
+
+  void
+  Utf8StreamDecoder::reset()
+  {
+    m_state = UTF8_DFA_ACCEPT;
+    m_partial = 0;
+    m_seen = 0;
+    m_offset = 0;
+    m_error = UTF8_OK;
+    m_errorOffset = 0;
+    m_numErrors = 0;
+    m_failed = false;
+  }
+
+  void
+  Utf8StreamDecoder::recordError(Utf8Error kind, uint64_t offset)
+  {
+    if (m_numErrors++ == 0) {
+      m_error = kind;
+      m_errorOffset = offset;
+    }
+
+    if (m_mode == UTF8_STOP)
+      m_failed = true;
+  }
+
+  size_t
+  Utf8StreamDecoder::decode(const char *buf, size_t len,
+                            CodePoint_t *out, size_t outLen,
+                            const char **next)
+  {
+    const char *s = buf;
+    const char *bound = buf + len;
+    CodePoint_t *o = out;
+    CodePoint_t *oBound = out + outLen;
+
+    // The state lives in locals for the duration of the loop.
+    uint32_t state = m_state;
+    CodePoint_t partial = m_partial;
+    unsigned seen = m_seen;
+
+    while (!m_failed && s != bound && o != oBound) {
+      unsigned char b = *s;
+      if (state == UTF8_DFA_ACCEPT && b < 0x80) {
+        // ASCII runs are widened in bulk by utf8_decode_all().
+        size_t room = std::min<size_t>(bound - s, oBound - o);
+        size_t n = utf8_ascii_span(s, room);
+        utf8_decode_all(s, n, o);
+        s += n;
+        o += n;
+        continue;
+      }
+
+      uint32_t prev = state;
+      state = utf8_dfa_step(state, partial, b);
+
+      if (state == UTF8_DFA_REJECT) {
+        // The refused byte is part of the ill-formed sequence only if
+        // it was meant to start it; otherwise it is decoded afresh.
+        uint64_t here = m_offset + (s - buf);
+        state = UTF8_DFA_ACCEPT;
+        if (prev == UTF8_DFA_ACCEPT) {
+          recordError(utf8_dfa_error(prev, b), here);
+          if (m_failed)
+            break;
+          s++;
+        }
+        else {
+          recordError(utf8_dfa_error(prev, b), here - seen);
+          seen = 0;
+          if (m_failed)
+            break;
+        }
+
+        *o++ = UTF8_REPLACEMENT_CHARACTER;
+        continue;
+      }
+
+      // There is room for the code point, so it is stored whether or
+      // not it is complete, and kept only once it is.
+      *o = partial;
+      o += (state == UTF8_DFA_ACCEPT);
+      seen = (state == UTF8_DFA_ACCEPT) ? 0 : seen + 1;
+      s++;
+    }
+
+    m_state = state;
+    m_partial = partial;
+    m_seen = seen;
+    m_offset += s - buf;
+
+    if (next)
+      *next = s;
+
+    return o - out;
+  }
+
+  size_t
+  Utf8StreamDecoder::finish(CodePoint_t *out)
+  {
+    if (m_failed || m_state == UTF8_DFA_ACCEPT)
+      return 0;
+
+    recordError(UTF8_TRUNCATED, m_offset - m_seen);
+    m_state = UTF8_DFA_ACCEPT;
+    m_seen = 0;
+
+    if (m_failed || !out)
+      return 0;
+
+    *out = UTF8_REPLACEMENT_CHARACTER;
+    return 1;
+  }
+}
@@ -0,0 +1,138 @@
+#ifndef UTF8STREAMDECODER_H
+#define UTF8STREAMDECODER_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "CodePoint.h"
+#include "Utf8Dfa.h"
+#include "utf8.h"
+
+namespace libucd {
+  /// @brief Incremental UTF-8 decoder for input that arrives in chunks,
+  /// e.g. from successive read() calls on a file or a pipe.
+  ///
+  /// utf8_decode() cannot resume a sequence that is cut off at the end
+  /// of its buffer, so a caller that uses it must have the whole input
+  /// in memory. The stream decoder instead keeps the bytes of a
+  /// sequence that is still incomplete at the end of one chunk as part
+  /// of its state, and completes it from the start of the next, so a
+  /// fixed-size buffer can be reused for any amount of input.
+  ///
+  /// The state is that of the DFA used by utf8_decode_checked(), so
+  /// only well-formed UTF-8 (Unicode Table 3-7) is accepted; unlike
+  /// utf8_decode(), overlong forms and surrogates are rejected. In
+  /// UTF8_STOP mode decoding stops at the first ill-formed sequence,
+  /// and the decoder stays failed until reset(). In UTF8_REPLACE mode
+  /// each maximal ill-formed subpart becomes one U+FFFD, exactly as
+  /// utf8_decode_checked() would have it for the whole input at once.
+  class Utf8StreamDecoder
+  {
+      Utf8ErrorMode m_mode;
+      uint32_t m_state;         // DFA state
+      CodePoint_t m_partial;    // bits of the sequence in progress
+      unsigned m_seen;          // bytes of the sequence already taken
+      uint64_t m_offset;        // bytes consumed since reset()
+      Utf8Error m_error;
+      uint64_t m_errorOffset;
+      uint64_t m_numErrors;
+      bool m_failed;
+
+      void recordError(Utf8Error kind, uint64_t offset);
+
+    public:
+      explicit Utf8StreamDecoder(Utf8ErrorMode mode = UTF8_STOP);
+
+      /// @brief Forget any partial sequence and any error, and start
+      /// counting offsets from zero again.
+      void reset();
+
+      /// @brief Decode the @p len bytes at @p buf into the @p outLen
+      /// code points at @p out, returning the number written.
+      ///
+      /// Decoding stops when the input is used up, when @p out is full
+      /// or, in UTF8_STOP mode, at an ill-formed sequence. If @p next is
+      /// non-NULL, @p *next is set to the first byte that was not
+      /// consumed; the caller passes the bytes from there on again in
+      /// the next call. The bytes of a sequence that is incomplete at
+      /// the end of @p buf are consumed, and are held until the rest of
+      /// it arrives.
+      ///
+      /// An output buffer of @p len code points is large enough to
+      /// consume the whole of @p buf, plus one if pending() is true
+      /// before the call: in UTF8_REPLACE mode, a held sequence that
+      /// the first byte of @p buf cuts short becomes a U+FFFD of its
+      /// own, ahead of the code point of that byte. With a smaller
+      /// buffer, decoding stops when it is full and resumes at @p *next.
+      size_t decode(const char *buf, size_t len,
+                    CodePoint_t *out, size_t outLen,
+                    const char **next = 0);
+
+      /// @brief Signal the end of the input. A sequence that is still
+      /// incomplete is a UTF8_TRUNCATED error, at the offset of its
+      /// first byte: in UTF8_STOP mode the decoder fails, and in
+      /// UTF8_REPLACE mode U+FFFD is written to @p out, if it is non-NULL.
+      /// Returns the number of code points written.
+      size_t finish(CodePoint_t *out = 0);
+
+      /// @brief True if the bytes of an incomplete sequence are held.
+      bool pending() const { return m_state != 0; }
+
+      /// @brief True once decoding has stopped at an ill-formed
+      /// sequence. Only happens in UTF8_STOP mode.
+      bool failed() const { return m_failed; }
+
+      /// @brief Number of bytes consumed since the last reset().
+      uint64_t offset() const { return m_offset; }
+
+      /// @brief The first error since the last reset(), or UTF8_OK.
+      Utf8Error error() const { return m_error; }
+
+      /// @brief The offset since the last reset() of the first byte of
+      /// the first ill-formed sequence, if error() is not UTF8_OK.
+      uint64_t errorOffset() const { return m_errorOffset; }
+
+      /// @brief Number of ill-formed sequences since the last reset().
+      uint64_t numErrors() const { return m_numErrors; }
+  };
+}
+
+#endif // UTF8STREAMDECODER_H
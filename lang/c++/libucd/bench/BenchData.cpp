@@ -0,0 +1,174 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+#include <random>
+
+#include "BenchData.h"
+#include "utf8.h"
+
+using namespace libucd;
+
+static const size_t CORPUS_BYTES = 1 << 20;
+
+static std::string
+buildCorpus(Corpus corpus)
+{
+  static const char *const SOURCE =
+    "int main(int argc, char *argv[])\n"
+    "{\n"
+    "  for (size_t i = 0; i < table.size(); i++)\n"
+    "    total += table[i].weight * scale; // accumulate\n"
+    "  return total > limit ? EXIT_FAILURE : EXIT_SUCCESS;\n"
+    "}\n";
+  static const char *const MIXED[] = {
+    "  résumé_count += naïve_estimate(Δx, Δy);\n",
+    "  // 计算 总和 and return it\n",
+    "  auto Ωmega = Σ(values) / n; // 😀\n",
+  };
+
+  std::mt19937 rng(42);
+  std::string text;
+
+  while (text.size() < CORPUS_BYTES) {
+    switch (corpus) {
+    case CORPUS_ASCII:
+      text += SOURCE;
+      break;
+    case CORPUS_CJK:
+      text += utf8_encode(0x4e00 + rng() % 0x5200);
+      break;
+    case CORPUS_EMOJI:
+      text += utf8_encode(0x1f300 + rng() % 0x300);
+      break;
+    case CORPUS_MIXED:
+      text += SOURCE;
+      text += MIXED[rng() % 3];
+      break;
+    }
+  }
+
+  return text;
+}
+
+const std::string&
+corpusText(Corpus corpus)
+{
+  static std::string texts[4];
+  if (texts[corpus].empty())
+    texts[corpus] = buildCorpus(corpus);
+  return texts[corpus];
+}
+
+const std::vector<CodePoint_t>&
+corpusCodePoints(Corpus corpus)
+{
+  static std::vector<CodePoint_t> cps[4];
+  if (cps[corpus].empty()) {
+    const std::string& text = corpusText(corpus);
+    cps[corpus].resize(text.size());
+    cps[corpus].resize(utf8_decode_all(text.data(), text.size(), cps[corpus].data()));
+  }
+  return cps[corpus];
+}
+
+const char *
+corpusName(Corpus corpus)
+{
+  static const char *const NAMES[] = { "ascii", "cjk", "emoji", "mixed" };
+  return NAMES[corpus];
+}
+
+// Append /count/ disjoint, non-adjacent ranges spread over [first, last).
+static void
+spreadRanges(CodePointSet& set, std::mt19937& rng, CodePoint_t first,
+             CodePoint_t last, size_t count)
+{
+  if (count == 0)
+    return;
+
+  CodePoint_t stride = (last - first) / count;
+  CodePoint_t cp = first;
+
+  for (size_t i = 0; i < count; i++) {
+    cp += 1 + rng() % (stride / 2);
+    CodePoint_t len = rng() % (stride / 2);
+    set.insert(CodePointRange(cp, cp + len));
+    cp += len + 1;
+  }
+}
+
+CodePointSet
+propertyLikeSet(size_t nRanges, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  CodePointSet set;
+
+  // Seven in eight ranges fall in the BMP, the rest in planes 1 and 2.
+  size_t nBmp = nRanges - nRanges / 8;
+  spreadRanges(set, rng, 0, 0x10000, nBmp);
+  spreadRanges(set, rng, 0x10000, 0x30000, nRanges - nBmp);
+
+  return set;
+}
+
+std::vector<CodePointRange>
+randomRanges(size_t n, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  std::vector<CodePointRange> ranges;
+
+  for (size_t i = 0; i < n; i++) {
+    CodePoint_t base = rng() % CODEPOINT_MAX;
+    ranges.push_back(CodePointRange(base, std::min<CodePoint_t>(CODEPOINT_MAX, base + rng() % 64)));
+  }
+
+  return ranges;
+}
+
+std::vector<CodePoint_t>
+randomCodePoints(size_t n, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  std::vector<CodePoint_t> cps;
+
+  for (size_t i = 0; i < n; i++)
+    cps.push_back(rng() % 0x20000);
+
+  return cps;
+}
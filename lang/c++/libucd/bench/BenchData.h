@@ -0,0 +1,76 @@
+#ifndef BENCHDATA_H
+#define BENCHDATA_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <string>
+#include <vector>
+
+#include "CodePointSet.h"
+
+/// @brief Input corpora for the UTF-8 benchmarks, each about 1 MB.
+enum Corpus {
+  CORPUS_ASCII,     // C-like source text
+  CORPUS_CJK,       // CJK Unified Ideographs (3-byte sequences)
+  CORPUS_EMOJI,     // supplementary-plane pictographs (4-byte sequences)
+  CORPUS_MIXED      // ASCII source with non-ASCII identifiers and comments
+};
+
+/// @brief The UTF-8 text of @p corpus. Built once, deterministically.
+const std::string& corpusText(Corpus corpus);
+
+/// @brief The code points of @p corpus.
+const std::vector<libucd::CodePoint_t>& corpusCodePoints(Corpus corpus);
+
+/// @brief Name of @p corpus, for benchmark labels.
+const char *corpusName(Corpus corpus);
+
+/// @brief A deterministic pseudo-random set of @p nRanges ranges shaped
+/// like a real property: mostly short ranges, concentrated in the BMP,
+/// with a few in the supplementary planes. (Alphabetic has about 700
+/// ranges and ID_Continue about 750.)
+libucd::CodePointSet propertyLikeSet(size_t nRanges, unsigned seed);
+
+/// @brief @p n random closed ranges, in random order.
+std::vector<libucd::CodePointRange> randomRanges(size_t n, unsigned seed);
+
+/// @brief @p n random code points.
+std::vector<libucd::CodePoint_t> randomCodePoints(size_t n, unsigned seed);
+
+#endif // BENCHDATA_H
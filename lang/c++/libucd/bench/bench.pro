@@ -0,0 +1,25 @@
+# Google Benchmark suite for libucd.
+#
+# Not built by default; enable it from the top level with
+#
+#     qmake CONFIG+=bench
+#
+# and run ./libucd-bench from the build directory.
+
+TEMPLATE = app
+TARGET = libucd-bench
+CONFIG += console c++11 thread
+CONFIG -= app_bundle
+CONFIG -= qt
+
+INCLUDEPATH += ..
+LIBS += -L$$OUT_PWD/.. -llibucd -lbenchmark
+PRE_TARGETDEPS += $$OUT_PWD/../liblibucd.a
+
+SOURCES += bench_main.cpp \
+    BenchData.cpp \
+    bench_codepointset.cpp \
+    bench_utf8.cpp
+
+HEADERS += \
+    BenchData.h
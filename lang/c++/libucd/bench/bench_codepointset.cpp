@@ -0,0 +1,295 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+
+#include "BenchData.h"
+#include "CodePointSet.h"
+#include "FrozenCodePointSet.h"
+#include "HybridCodePointSet.h"
+#include "MemoryResource.h"
+
+using namespace libucd;
+
+// Range counts: a small property, Alphabetic-sized, and a large one.
+#define SET_SIZES Arg(64)->Arg(700)->Arg(4000)
+
+static void
+BM_CodePointSet_insert_sorted(benchmark::State& state)
+{
+  std::vector<CodePointRange> ranges = randomRanges(state.range(0), 1);
+  std::sort(ranges.begin(), ranges.end(),
+            [](const CodePointRange& a, const CodePointRange& b) {
+              return a.min() < b.min();
+            });
+
+  for (auto _ : state) {
+    CodePointSet set;
+    for (size_t i = 0; i < ranges.size(); i++)
+      set.insert(ranges[i]);
+    benchmark::DoNotOptimize(set.size());
+  }
+
+  state.SetItemsProcessed(int64_t(state.iterations()) * ranges.size());
+}
+BENCHMARK(BM_CodePointSet_insert_sorted)->SET_SIZES;
+
+static void
+BM_CodePointSet_insert_random(benchmark::State& state)
+{
+  std::vector<CodePointRange> ranges = randomRanges(state.range(0), 2);
+
+  for (auto _ : state) {
+    CodePointSet set;
+    for (size_t i = 0; i < ranges.size(); i++)
+      set.insert(ranges[i]);
+    benchmark::DoNotOptimize(set.size());
+  }
+
+  state.SetItemsProcessed(int64_t(state.iterations()) * ranges.size());
+}
+BENCHMARK(BM_CodePointSet_insert_random)->SET_SIZES;
+
+static void
+BM_CodePointSet_assign_sorted(benchmark::State& state)
+{
+  std::vector<CodePointRange> ranges = randomRanges(state.range(0), 1);
+  std::sort(ranges.begin(), ranges.end(),
+            [](const CodePointRange& a, const CodePointRange& b) {
+              return a.min() < b.min();
+            });
+
+  for (auto _ : state) {
+    CodePointSet set;
+    set.assign_sorted(ranges.begin(), ranges.end());
+    benchmark::DoNotOptimize(set.size());
+  }
+
+  state.SetItemsProcessed(int64_t(state.iterations()) * ranges.size());
+}
+BENCHMARK(BM_CodePointSet_assign_sorted)->SET_SIZES;
+
+static void
+BM_CodePointSet_erase_random(benchmark::State& state)
+{
+  CodePointSet base = propertyLikeSet(state.range(0), 3);
+  std::vector<CodePointRange> ranges = randomRanges(state.range(0), 4);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    CodePointSet set = base;
+    state.ResumeTiming();
+
+    for (size_t i = 0; i < ranges.size(); i++)
+      set.erase(ranges[i]);
+    benchmark::DoNotOptimize(set.size());
+  }
+
+  state.SetItemsProcessed(int64_t(state.iterations()) * ranges.size());
+}
+BENCHMARK(BM_CodePointSet_erase_random)->SET_SIZES;
+
+// Split a random sample of code points into members and non-members of
+// /set/, so that hits and misses can be timed separately.
+template<class Set>
+static void
+sampleQueries(const Set& set, std::vector<CodePoint_t>& hits,
+              std::vector<CodePoint_t>& misses)
+{
+  std::vector<CodePoint_t> cps = randomCodePoints(1 << 16, 5);
+  for (size_t i = 0; i < cps.size(); i++)
+    (set.contains(cps[i]) ? hits : misses).push_back(cps[i]);
+}
+
+template<class Set>
+static void
+runContains(benchmark::State& state, const Set& set, bool hit)
+{
+  std::vector<CodePoint_t> hits;
+  std::vector<CodePoint_t> misses;
+  sampleQueries(set, hits, misses);
+  const std::vector<CodePoint_t>& queries = hit ? hits : misses;
+
+  for (auto _ : state) {
+    size_t n = 0;
+    for (size_t i = 0; i < queries.size(); i++)
+      n += set.contains(queries[i]);
+    benchmark::DoNotOptimize(n);
+  }
+
+  state.SetItemsProcessed(int64_t(state.iterations()) * queries.size());
+}
+
+static void
+BM_CodePointSet_contains_hit(benchmark::State& state)
+{
+  runContains(state, propertyLikeSet(state.range(0), 6), true);
+}
+BENCHMARK(BM_CodePointSet_contains_hit)->SET_SIZES;
+
+static void
+BM_CodePointSet_contains_miss(benchmark::State& state)
+{
+  runContains(state, propertyLikeSet(state.range(0), 6), false);
+}
+BENCHMARK(BM_CodePointSet_contains_miss)->SET_SIZES;
+
+static void
+BM_FrozenCodePointSet_contains_hit(benchmark::State& state)
+{
+  runContains(state, propertyLikeSet(state.range(0), 6).freeze(), true);
+}
+BENCHMARK(BM_FrozenCodePointSet_contains_hit)->SET_SIZES;
+
+static void
+BM_FrozenCodePointSet_contains_miss(benchmark::State& state)
+{
+  runContains(state, propertyLikeSet(state.range(0), 6).freeze(), false);
+}
+BENCHMARK(BM_FrozenCodePointSet_contains_miss)->SET_SIZES;
+
+static FrozenCodePointSet
+indexedSet(size_t nRanges)
+{
+  FrozenCodePointSet set = propertyLikeSet(nRanges, 6).freeze();
+  set.buildIndex();
+  return set;
+}
+
+static void
+BM_FrozenCodePointSet_indexed_contains_hit(benchmark::State& state)
+{
+  runContains(state, indexedSet(state.range(0)), true);
+}
+BENCHMARK(BM_FrozenCodePointSet_indexed_contains_hit)->SET_SIZES;
+
+static void
+BM_FrozenCodePointSet_indexed_contains_miss(benchmark::State& state)
+{
+  runContains(state, indexedSet(state.range(0)), false);
+}
+BENCHMARK(BM_FrozenCodePointSet_indexed_contains_miss)->SET_SIZES;
+
+static void
+BM_HybridCodePointSet_contains_hit(benchmark::State& state)
+{
+  runContains(state, HybridCodePointSet(propertyLikeSet(state.range(0), 6)), true);
+}
+BENCHMARK(BM_HybridCodePointSet_contains_hit)->SET_SIZES;
+
+static void
+BM_HybridCodePointSet_contains_miss(benchmark::State& state)
+{
+  runContains(state, HybridCodePointSet(propertyLikeSet(state.range(0), 6)), false);
+}
+BENCHMARK(BM_HybridCodePointSet_contains_miss)->SET_SIZES;
+
+static void
+BM_CodePointSet_union(benchmark::State& state)
+{
+  CodePointSet a = propertyLikeSet(state.range(0), 7);
+  CodePointSet b = propertyLikeSet(state.range(0), 8);
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize((a | b).size());
+}
+BENCHMARK(BM_CodePointSet_union)->SET_SIZES;
+
+static void
+BM_CodePointSet_intersect(benchmark::State& state)
+{
+  CodePointSet a = propertyLikeSet(state.range(0), 7);
+  CodePointSet b = propertyLikeSet(state.range(0), 8);
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize((a & b).size());
+}
+BENCHMARK(BM_CodePointSet_intersect)->SET_SIZES;
+
+static void
+BM_CodePointSet_difference(benchmark::State& state)
+{
+  CodePointSet a = propertyLikeSet(state.range(0), 7);
+  CodePointSet b = propertyLikeSet(state.range(0), 8);
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize((a - b).size());
+}
+BENCHMARK(BM_CodePointSet_difference)->SET_SIZES;
+
+// A character class expression such as [\p{L}&&[^\p{Lu}]] plus a few
+// more terms, building and discarding a temporary set per operator.
+static size_t
+classExpression(const CodePointSet& a, const CodePointSet& b,
+                const CodePointSet& c)
+{
+  CodePointSet r = (a & ~b) | (c - a);
+  r += CodePointRange('a', 'z');
+  return (r ^ b.boundBy(CodePointRange(0, 0xffff))).size();
+}
+
+static void
+BM_CodePointSet_expression_heap(benchmark::State& state)
+{
+  CodePointSet a = propertyLikeSet(state.range(0), 7);
+  CodePointSet b = propertyLikeSet(state.range(0), 8);
+  CodePointSet c = propertyLikeSet(state.range(0), 9);
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(classExpression(a, b, c));
+}
+BENCHMARK(BM_CodePointSet_expression_heap)->SET_SIZES;
+
+static void
+BM_CodePointSet_expression_arena(benchmark::State& state)
+{
+  CodePointSet a = propertyLikeSet(state.range(0), 7);
+  CodePointSet b = propertyLikeSet(state.range(0), 8);
+  CodePointSet c = propertyLikeSet(state.range(0), 9);
+  MonotonicArena arena;
+
+  for (auto _ : state) {
+    {
+      DefaultResourceScope scope(&arena);
+      benchmark::DoNotOptimize(classExpression(a, b, c));
+    }
+    arena.release();
+  }
+}
+BENCHMARK(BM_CodePointSet_expression_arena)->SET_SIZES;
@@ -0,0 +1,443 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include "BenchData.h"
+#include "casefold.h"
+#include "HybridCodePointSet.h"
+#include "Utf8Iterator.h"
+#include "Utf8Matcher.h"
+#include "Utf8OffsetIndex.h"
+#include "Utf8StreamDecoder.h"
+#include "utf8.h"
+
+using namespace libucd;
+
+// Each UTF-8 benchmark takes the corpus as its argument.
+#define CORPORA DenseRange(CORPUS_ASCII, CORPUS_MIXED)
+
+static void
+BM_utf8_decode(benchmark::State& state)
+{
+  Corpus corpus = Corpus(state.range(0));
+  const std::string& text = corpusText(corpus);
+
+  for (auto _ : state) {
+    const char *s = text.data();
+    const char *bound = s + text.size();
+    CodePoint_t sum = 0;
+
+    while (s < bound) {
+      const char *next;
+      CodePoint_t c = utf8_decode(s, &next, bound);
+      if (c == CODEPOINT_EOF)
+        break;
+      sum += c;
+      s = next;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+
+  state.SetBytesProcessed(int64_t(state.iterations()) * text.size());
+  state.SetLabel(corpusName(corpus));
+}
+BENCHMARK(BM_utf8_decode)->CORPORA;
+
+static void
+BM_utf8_iterator(benchmark::State& state)
+{
+  Corpus corpus = Corpus(state.range(0));
+  const std::string& text = corpusText(corpus);
+
+  for (auto _ : state) {
+    CodePoint_t sum = 0;
+    for (CodePoint_t c : utf8_range(text.data(), text.size()))
+      sum += c;
+    benchmark::DoNotOptimize(sum);
+  }
+
+  state.SetBytesProcessed(int64_t(state.iterations()) * text.size());
+  state.SetLabel(corpusName(corpus));
+}
+BENCHMARK(BM_utf8_iterator)->CORPORA;
+
+static void
+BM_utf8_decode_all(benchmark::State& state)
+{
+  Corpus corpus = Corpus(state.range(0));
+  const std::string& text = corpusText(corpus);
+  std::vector<CodePoint_t> out(text.size());
+
+  for (auto _ : state) {
+    size_t n = utf8_decode_all(text.data(), text.size(), out.data());
+    benchmark::DoNotOptimize(n);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(int64_t(state.iterations()) * text.size());
+  state.SetLabel(corpusName(corpus));
+}
+BENCHMARK(BM_utf8_decode_all)->CORPORA;
+
+static void
+BM_utf8_decode_checked(benchmark::State& state)
+{
+  Corpus corpus = Corpus(state.range(0));
+  const std::string& text = corpusText(corpus);
+  std::vector<CodePoint_t> out(text.size());
+
+  for (auto _ : state) {
+    size_t n = utf8_decode_checked(text.data(), text.size(), out.data());
+    benchmark::DoNotOptimize(n);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(int64_t(state.iterations()) * text.size());
+  state.SetLabel(corpusName(corpus));
+}
+BENCHMARK(BM_utf8_decode_checked)->CORPORA;
+
+static void
+BM_utf8_decode_checked_hostile(benchmark::State& state)
+{
+  // The corpus with one byte in every 61 overwritten by one that cannot
+  // appear in well-formed text at that point, decoded with replacement.
+  Corpus corpus = Corpus(state.range(0));
+  std::string text = corpusText(corpus);
+  static const char junk[] = { '\x80', '\xc0', '\xed', '\xf4', '\xff' };
+  for (size_t i = 0, k = 0; i < text.size(); i += 61, k++)
+    text[i] = junk[k % sizeof(junk)];
+  std::vector<CodePoint_t> out(text.size());
+
+  for (auto _ : state) {
+    size_t n = utf8_decode_checked(text.data(), text.size(), out.data(),
+                                   UTF8_REPLACE);
+    benchmark::DoNotOptimize(n);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(int64_t(state.iterations()) * text.size());
+  state.SetLabel(corpusName(corpus));
+}
+BENCHMARK(BM_utf8_decode_checked_hostile)->CORPORA;
+
+static void
+BM_Utf8StreamDecoder(benchmark::State& state)
+{
+  Corpus corpus = Corpus(state.range(0));
+  const std::string& text = corpusText(corpus);
+
+  // Feed the text in read()-sized chunks, which split sequences, into a
+  // fixed-size output buffer.
+  const size_t CHUNK = 4096;
+  std::vector<CodePoint_t> out(CHUNK);
+
+  for (auto _ : state) {
+    Utf8StreamDecoder decoder;
+    size_t n = 0;
+    for (size_t pos = 0; pos < text.size(); pos += CHUNK) {
+      size_t len = std::min(CHUNK, text.size() - pos);
+      n += decoder.decode(text.data() + pos, len, out.data(), out.size());
+      benchmark::ClobberMemory();
+    }
+    n += decoder.finish(out.data());
+    benchmark::DoNotOptimize(n);
+  }
+
+  state.SetBytesProcessed(int64_t(state.iterations()) * text.size());
+  state.SetLabel(corpusName(corpus));
+}
+BENCHMARK(BM_Utf8StreamDecoder)->CORPORA;
+
+static void
+BM_utf8_validate(benchmark::State& state)
+{
+  Corpus corpus = Corpus(state.range(0));
+  const std::string& text = corpusText(corpus);
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(utf8_validate(text.data(), text.size()));
+
+  state.SetBytesProcessed(int64_t(state.iterations()) * text.size());
+  state.SetLabel(corpusName(corpus));
+}
+BENCHMARK(BM_utf8_validate)->CORPORA;
+
+static void
+BM_utf8_encode_string(benchmark::State& state)
+{
+  Corpus corpus = Corpus(state.range(0));
+  const std::vector<CodePoint_t>& cps = corpusCodePoints(corpus);
+
+  for (auto _ : state) {
+    size_t total = 0;
+    for (size_t i = 0; i < cps.size(); i++)
+      total += utf8_encode(cps[i]).size();
+    benchmark::DoNotOptimize(total);
+  }
+
+  state.SetItemsProcessed(int64_t(state.iterations()) * cps.size());
+  state.SetLabel(corpusName(corpus));
+}
+BENCHMARK(BM_utf8_encode_string)->CORPORA;
+
+static void
+BM_utf8_encode_buffer(benchmark::State& state)
+{
+  Corpus corpus = Corpus(state.range(0));
+  const std::vector<CodePoint_t>& cps = corpusCodePoints(corpus);
+  std::vector<char> out(cps.size() * 4);
+
+  for (auto _ : state) {
+    char *s = out.data();
+    for (size_t i = 0; i < cps.size(); i++)
+      utf8_encode(cps[i], s, &s);
+    benchmark::DoNotOptimize(s);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(int64_t(state.iterations()) * cps.size());
+  state.SetLabel(corpusName(corpus));
+}
+BENCHMARK(BM_utf8_encode_buffer)->CORPORA;
+
+static void
+BM_utf8_encode_all(benchmark::State& state)
+{
+  Corpus corpus = Corpus(state.range(0));
+  const std::vector<CodePoint_t>& cps = corpusCodePoints(corpus);
+  std::vector<char> out(utf8_encoded_length(cps.data(), cps.size()));
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(utf8_encode_all(cps.data(), cps.size(), out.data()));
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(int64_t(state.iterations()) * cps.size());
+  state.SetLabel(corpusName(corpus));
+}
+BENCHMARK(BM_utf8_encode_all)->CORPORA;
+
+static void
+BM_utf8_cplen(benchmark::State& state)
+{
+  Corpus corpus = Corpus(state.range(0));
+  const std::string& text = corpusText(corpus);
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(utf8_cplen(text.data(), text.data() + text.size()));
+
+  state.SetBytesProcessed(int64_t(state.iterations()) * text.size());
+  state.SetLabel(corpusName(corpus));
+}
+BENCHMARK(BM_utf8_cplen)->CORPORA;
+
+static void
+BM_Utf8OffsetIndex_build(benchmark::State& state)
+{
+  Corpus corpus = Corpus(state.range(0));
+  const std::string& text = corpusText(corpus);
+
+  for (auto _ : state) {
+    Utf8OffsetIndex index(text.data(), text.size());
+    benchmark::DoNotOptimize(index.size());
+  }
+
+  state.SetBytesProcessed(int64_t(state.iterations()) * text.size());
+  state.SetLabel(corpusName(corpus));
+}
+BENCHMARK(BM_Utf8OffsetIndex_build)->CORPORA;
+
+static void
+BM_Utf8OffsetIndex_codePointIndex(benchmark::State& state)
+{
+  Corpus corpus = Corpus(state.range(0));
+  const std::string& text = corpusText(corpus);
+  Utf8OffsetIndex index(text.data(), text.size());
+  std::vector<CodePoint_t> offsets = randomCodePoints(4096, 11);
+
+  for (auto _ : state) {
+    size_t sum = 0;
+    for (size_t i = 0; i < offsets.size(); i++)
+      sum += index.codePointIndex(offsets[i] % text.size());
+    benchmark::DoNotOptimize(sum);
+  }
+
+  state.SetItemsProcessed(int64_t(state.iterations()) * offsets.size());
+  state.SetLabel(corpusName(corpus));
+}
+BENCHMARK(BM_Utf8OffsetIndex_codePointIndex)->CORPORA;
+
+// An identifier-like class for the tokenizer benchmarks: ASCII letters,
+// digits and '_', plus a property-like spread of non-ASCII ranges.
+static CodePointSet
+identifierSet()
+{
+  CodePointSet set = propertyLikeSet(700, 12);
+  set += CodePointRange('0', '9');
+  set += CodePointRange('A', 'Z');
+  set += CodePointRange('_');
+  set += CodePointRange('a', 'z');
+  return set;
+}
+
+// Split the corpus into runs of code points in the identifier set, as
+// a tokenizer would, and count them.
+static void
+BM_tokenize_decode_contains(benchmark::State& state)
+{
+  Corpus corpus = Corpus(state.range(0));
+  const std::string& text = corpusText(corpus);
+  HybridCodePointSet set(identifierSet());
+
+  for (auto _ : state) {
+    const char *s = text.data();
+    const char *bound = s + text.size();
+    size_t tokens = 0;
+    bool inToken = false;
+
+    while (s < bound) {
+      const char *next;
+      CodePoint_t c = utf8_decode(s, &next, bound);
+      if (c == CODEPOINT_EOF)
+        break;
+      bool in = set.contains(c);
+      tokens += (in && !inToken);
+      inToken = in;
+      s = next;
+    }
+    benchmark::DoNotOptimize(tokens);
+  }
+
+  state.SetBytesProcessed(int64_t(state.iterations()) * text.size());
+  state.SetLabel(corpusName(corpus));
+}
+BENCHMARK(BM_tokenize_decode_contains)->CORPORA;
+
+static void
+BM_tokenize_Utf8Matcher(benchmark::State& state)
+{
+  Corpus corpus = Corpus(state.range(0));
+  const std::string& text = corpusText(corpus);
+  Utf8Matcher matcher(identifierSet());
+
+  for (auto _ : state) {
+    const char *s = text.data();
+    const char *bound = s + text.size();
+    size_t tokens = 0;
+
+    while (s < bound) {
+      size_t n = matcher.span(s, bound);
+      if (n > 0) {
+        tokens++;
+        s += n;
+      }
+      else {
+        // Step over one code point that is not in the set.
+        do
+          s++;
+        while (s < bound && (*s & 0xc0) == 0x80);
+      }
+    }
+    benchmark::DoNotOptimize(tokens);
+  }
+
+  state.SetBytesProcessed(int64_t(state.iterations()) * text.size());
+  state.SetLabel(corpusName(corpus));
+}
+BENCHMARK(BM_tokenize_Utf8Matcher)->CORPORA;
+
+// A stand-in for the generated lookup_casefold(): folds the capitals of
+// Latin-1, Greek and Cyrillic, which are the ones in the corpora.
+static CodePoint_t
+benchFold(CodePoint_t cp)
+{
+  if ((cp >= 'A' && cp <= 'Z') || (cp >= 0xc0 && cp <= 0xde && cp != 0xd7) ||
+      (cp >= 0x391 && cp <= 0x3ab) || (cp >= 0x410 && cp <= 0x42f))
+    return cp + 0x20;
+  return cp;
+}
+
+// The corpus with its ASCII letters upper-cased.
+static std::string
+upperCorpus(Corpus corpus)
+{
+  std::string text = corpusText(corpus);
+  for (size_t i = 0; i < text.size(); i++) {
+    if (text[i] >= 'a' && text[i] <= 'z')
+      text[i] -= 0x20;
+  }
+  return text;
+}
+
+static void
+BM_utf8_casefold_into(benchmark::State& state)
+{
+  Corpus corpus = Corpus(state.range(0));
+  std::string text = upperCorpus(corpus);
+  std::string out(utf8_casefold_bound(text.size()), '\0');
+
+  for (auto _ : state) {
+    size_t n = utf8_casefold_into(text.data(), text.size(),
+                                  &out[0], out.size(), benchFold);
+    benchmark::DoNotOptimize(n);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(int64_t(state.iterations()) * text.size());
+  state.SetLabel(corpusName(corpus));
+}
+BENCHMARK(BM_utf8_casefold_into)->CORPORA;
+
+static void
+BM_utf8_caseless_equal(benchmark::State& state)
+{
+  Corpus corpus = Corpus(state.range(0));
+  const std::string& text = corpusText(corpus);
+  std::string upper = upperCorpus(corpus);
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(utf8_caseless_equal(text.data(), text.size(),
+                                                 upper.data(), upper.size(),
+                                                 benchFold));
+
+  state.SetBytesProcessed(int64_t(state.iterations()) * text.size());
+  state.SetLabel(corpusName(corpus));
+}
+BENCHMARK(BM_utf8_caseless_equal)->CORPORA;
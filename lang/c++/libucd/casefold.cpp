@@ -0,0 +1,199 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include "casefold.h"
+#include "Utf8Dfa.h"
+#include "utf8.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CASEFOLD_HAVE_SSE2 1
+#endif
+
+namespace libucd {
+  static inline unsigned char
+  foldAscii(unsigned char c)
+  {
+    return c + (((unsigned) (c - 'A') < 26) << 5);
+  }
+
+  // Fold /cp/, keeping ASCII away from /fold/ as casefold.h promises.
+  static inline CodePoint_t
+  foldCodePoint(CodePoint_t cp, CaseFoldFunction fold)
+  {
+    return (cp < 0x80) ? foldAscii(cp) : fold(cp);
+  }
+
+#ifdef CASEFOLD_HAVE_SSE2
+  // Fold the 16 ASCII bytes of /v/. Bytes are compared as signed, so
+  // that non-ASCII bytes would fall below 'A'.
+  static inline __m128i
+  foldAscii16(__m128i v)
+  {
+    __m128i upper =
+      _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+                    _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+    return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+  }
+#endif
+
+  // Decode the well-formed sequence at /s/ into /cp/, returning its
+  // length, or return 0 if it is ill-formed or cut off by /bound/.
+  static inline size_t
+  decodeOne(const char *s, const char *bound, CodePoint_t& cp)
+  {
+    const char *p = s;
+    uint32_t state = UTF8_DFA_ACCEPT;
+    do {
+      if (p == bound)
+        return 0;
+      state = utf8_dfa_step(state, cp, *p++);
+      if (state == UTF8_DFA_REJECT)
+        return 0;
+    } while (state != UTF8_DFA_ACCEPT);
+
+    return p - s;
+  }
+
+  size_t
+  utf8_casefold_into(const char *s, size_t len, char *out, size_t outLen,
+                     CaseFoldFunction fold, const char **next)
+  {
+    const char *bound = s + len;
+    char *o = out;
+    char *oBound = out + outLen;
+
+    while (s != bound) {
+#ifdef CASEFOLD_HAVE_SSE2
+      while ((bound - s) >= 16 && (oBound - o) >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *) s);
+        if (_mm_movemask_epi8(v))
+          break;
+
+        _mm_storeu_si128((__m128i *) o, foldAscii16(v));
+        s += 16;
+        o += 16;
+      }
+      if (s == bound)
+        break;
+#endif
+
+      unsigned char b0 = *s;
+      if (b0 < 0x80) {
+        if (o == oBound)
+          break;
+        *o++ = foldAscii(b0);
+        s++;
+        continue;
+      }
+
+      CodePoint_t cp;
+      size_t n = decodeOne(s, bound, cp);
+      if (n == 0)
+        break;
+
+      CodePoint_t folded = fold(cp);
+      if (size_t(oBound - o) < utf8_encoded_length(folded))
+        break;
+
+      char *oNext;
+      utf8_encode(folded, o, &oNext);
+      o = oNext;
+      s += n;
+    }
+
+    if (next)
+      *next = s;
+
+    return o - out;
+  }
+
+  bool
+  utf8_caseless_equal(const char *a, size_t aLen, const char *b, size_t bLen,
+                      CaseFoldFunction fold)
+  {
+    const char *aBound = a + aLen;
+    const char *bBound = b + bLen;
+
+    while (a != aBound && b != bBound) {
+#ifdef CASEFOLD_HAVE_SSE2
+      // Where both strings go on with 16 ASCII bytes, those are 16 code
+      // points on each side, and can be compared a vector at a time.
+      while ((aBound - a) >= 16 && (bBound - b) >= 16) {
+        __m128i va = _mm_loadu_si128((const __m128i *) a);
+        __m128i vb = _mm_loadu_si128((const __m128i *) b);
+        if (_mm_movemask_epi8(_mm_or_si128(va, vb)))
+          break;
+
+        __m128i eq = _mm_cmpeq_epi8(foldAscii16(va), foldAscii16(vb));
+        if (_mm_movemask_epi8(eq) != 0xffff)
+          return false;
+        a += 16;
+        b += 16;
+      }
+      if (a == aBound || b == bBound)
+        break;
+#endif
+
+      unsigned char ca = *a;
+      unsigned char cb = *b;
+      if ((ca | cb) < 0x80) {
+        if (foldAscii(ca) != foldAscii(cb))
+          return false;
+        a++;
+        b++;
+        continue;
+      }
+
+      // One side may still be ASCII, and a non-ASCII code point may
+      // fold to ASCII (U+212A KELVIN SIGN to 'k').
+      CodePoint_t x, y;
+      size_t n = decodeOne(a, aBound, x);
+      size_t m = decodeOne(b, bBound, y);
+      if (n == 0 || m == 0)
+        return false;
+      if (x != y && foldCodePoint(x, fold) != foldCodePoint(y, fold))
+        return false;
+
+      a += n;
+      b += m;
+    }
+
+    return a == aBound && b == bBound;
+  }
+}
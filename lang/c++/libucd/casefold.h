@@ -0,0 +1,97 @@
+#ifndef CASEFOLD_H
+#define CASEFOLD_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <stddef.h>
+
+#include "CodePoint.h"
+
+namespace libucd {
+  /// @brief A simple case folding (Unicode scf), which maps each code
+  /// point to a single code point.
+  ///
+  /// libucd carries no Unicode tables of its own, so this is supplied by
+  /// the client, normally as the lookup function that gen-props emits
+  /// from CaseFolding.txt:
+  ///
+  ///     gen-props casefold -o casefold CaseFolding.txt
+  ///
+  /// which defines lookup_casefold(). The routines below fold ASCII
+  /// themselves, a vector at a time where they can, and only call the
+  /// function for other code points; gen-props checks that the table
+  /// agrees with them, mapping A-Z to a-z and nothing else in ASCII.
+  typedef CodePoint_t (*CaseFoldFunction)(CodePoint_t cp);
+
+  /// @brief A size of output buffer for utf8_casefold_into() that is
+  /// large enough for any @p len bytes of input. Simple case folding
+  /// never lengthens a sequence by more than one byte (U+023A, two
+  /// bytes, folds to U+2C65, three), and ASCII not at all.
+  static inline size_t
+  utf8_casefold_bound(size_t len)
+  {
+    return len + len / 2;
+  }
+
+  /// @brief Write the simple case folding of the @p len bytes of UTF-8
+  /// at @p s to the @p outLen bytes at @p out, returning the number of
+  /// bytes written.
+  ///
+  /// Folding stops at the first ill-formed sequence, or at the first
+  /// code point whose folding does not fit in the rest of @p out. If
+  /// @p next is non-NULL, @p *next is set to the first byte that was not
+  /// folded (@p s + @p len if all were). Nothing is allocated.
+  size_t utf8_casefold_into(const char *s, size_t len,
+                            char *out, size_t outLen,
+                            CaseFoldFunction fold, const char **next = 0);
+
+  /// @brief Return true if the @p aLen bytes of UTF-8 at @p a and the
+  /// @p bLen bytes at @p b are equal under simple case folding.
+  ///
+  /// The strings need not be the same length in bytes (U+212A KELVIN
+  /// SIGN matches 'k'). Only simple folding is applied, so strings that
+  /// are equal only under full folding, such as "Straße" and
+  /// "STRASSE", are not equal. Ill-formed UTF-8 is equal to nothing.
+  /// Nothing is allocated.
+  bool utf8_caseless_equal(const char *a, size_t aLen,
+                           const char *b, size_t bLen,
+                           CaseFoldFunction fold);
+}
+
+#endif // CASEFOLD_H
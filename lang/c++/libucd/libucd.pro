@@ -10,12 +10,42 @@ TARGET = libucd
 TEMPLATE = lib
 CONFIG += staticlib
 
-SOURCES += CodePointSet.cpp \
+SOURCES += AliasFile.cpp \
+    casefold.cpp \
+    CodePointSet.cpp \
+    FrozenCodePointSet.cpp \
+    HybridCodePointSet.cpp \
+    MappedFile.cpp \
+    MemoryResource.cpp \
+    nfc.cpp \
+    UcdDatabase.cpp \
+    UcdDatabaseWriter.cpp \
+    Utf8Dfa.cpp \
+    Utf8Matcher.cpp \
+    Utf8OffsetIndex.cpp \
+    Utf8StreamDecoder.cpp \
     utf8.cpp
 
-HEADERS += CodePointSet.h \
+HEADERS += AliasFile.h \
+    casefold.h \
+    CodePointSet.h \
     CodePoint.h \
     CodePointRange.h \
+    CodePointRangeTable.h \
+    FrozenCodePointSet.h \
+    HybridCodePointSet.h \
+    LooseMatch.h \
+    MappedFile.h \
+    MemoryResource.h \
+    nfc.h \
+    UcdDatabase.h \
+    UcdDatabaseFormat.h \
+    UcdDatabaseWriter.h \
+    Utf8Dfa.h \
+    Utf8Iterator.h \
+    Utf8Matcher.h \
+    Utf8OffsetIndex.h \
+    Utf8StreamDecoder.h \
     utf8.h
 unix {
     target.path = /usr/lib
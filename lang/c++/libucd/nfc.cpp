@@ -0,0 +1,312 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include <utility>
+#include <vector>
+
+#include "Utf8Dfa.h"
+#include "nfc.h"
+#include "utf8.h"
+
+namespace libucd {
+  // Hangul syllable constants; see section 3.12 of the Unicode Standard.
+  static const CodePoint_t SBASE = 0xAC00;
+  static const CodePoint_t LBASE = 0x1100;
+  static const CodePoint_t VBASE = 0x1161;
+  static const CodePoint_t TBASE = 0x11A7;
+  static const CodePoint_t LCOUNT = 19;
+  static const CodePoint_t VCOUNT = 21;
+  static const CodePoint_t TCOUNT = 28;
+  static const CodePoint_t NCOUNT = VCOUNT * TCOUNT;
+  static const CodePoint_t SCOUNT = LCOUNT * NCOUNT;
+
+  // Every code point below U+0300 has Canonical_Combining_Class 0 and
+  // NFC_Quick_Check=Yes, and this has been true in every Unicode version.
+  static const CodePoint_t FIRST_COMBINING = 0x300;
+
+  // Decode the code point at /p/, advancing /p/ past it. Two-byte
+  // sequences below U+0300 (Latin-1 and friends) are handled inline,
+  // since they are the commonest non-ASCII code points in source text.
+  // Anything else goes through the strict automaton, so an ill-formed or
+  // truncated sequence yields CODEPOINT_EOF and leaves /p/ at its start.
+  static inline CodePoint_t
+  nextCodePoint(const char *&p, const char *bound)
+  {
+    unsigned char b0 = p[0];
+    if (b0 >= 0xc2 && b0 < 0xcc && (bound - p) >= 2 &&
+        ((unsigned char) p[1] & 0xc0) == 0x80) {
+      CodePoint_t cp = ((b0 & 0x1f) << 6) | (p[1] & 0x3f);
+      p += 2;
+      return cp;
+    }
+
+    const char *q = p;
+    CodePoint_t cp = 0;
+    uint32_t state = UTF8_DFA_ACCEPT;
+    do {
+      if (q == bound)
+        return CODEPOINT_EOF;
+      state = utf8_dfa_step(state, cp, *q++);
+      if (state == UTF8_DFA_REJECT)
+        return CODEPOINT_EOF;
+    } while (state != UTF8_DFA_ACCEPT);
+
+    p = q;
+    return cp;
+  }
+
+  static inline bool
+  isStableStarter(CodePoint_t cp, const NfcTables& t)
+  {
+    return (cp < FIRST_COMBINING) ||
+      ((t.combiningClass(cp) == 0) && (t.quickCheck(cp) == NFC_YES));
+  }
+
+  static void
+  decompose(CodePoint_t cp, const NfcTables& t, std::vector<CodePoint_t>& out)
+  {
+    if (cp >= SBASE && cp < SBASE + SCOUNT) {
+      CodePoint_t s = cp - SBASE;
+      out.push_back(LBASE + s / NCOUNT);
+      out.push_back(VBASE + (s % NCOUNT) / TCOUNT);
+      if (s % TCOUNT)
+        out.push_back(TBASE + s % TCOUNT);
+      return;
+    }
+
+    CodePoint_t mapping[NFC_MAX_MAPPING];
+    size_t n = t.decomposition(cp, mapping);
+    if (n == 0) {
+      out.push_back(cp);
+      return;
+    }
+
+    for (size_t i = 0; i < n; i++)
+      decompose(mapping[i], t, out);
+  }
+
+  static CodePoint_t
+  composePair(CodePoint_t first, CodePoint_t second, const NfcTables& t)
+  {
+    if (first >= LBASE && first < LBASE + LCOUNT &&
+        second >= VBASE && second < VBASE + VCOUNT)
+      return SBASE + ((first - LBASE) * VCOUNT + (second - VBASE)) * TCOUNT;
+
+    if (first >= SBASE && first < SBASE + SCOUNT &&
+        ((first - SBASE) % TCOUNT) == 0 &&
+        second > TBASE && second < TBASE + TCOUNT)
+      return first + (second - TBASE);
+
+    return t.compose(first, second);
+  }
+
+  static unsigned
+  combiningClass(CodePoint_t cp, const NfcTables& t)
+  {
+    return (cp < FIRST_COMBINING) ? 0 : t.combiningClass(cp);
+  }
+
+  // Normalize the segment [begin, end) to NFC and compare it with the
+  // original. This is the slow path, taken only for NFC_MAYBE.
+  static NfcQuickCheck
+  segmentIsNfc(const char *begin, const char *end, const NfcTables& t)
+  {
+    if (!t.decomposition || !t.compose)
+      return NFC_MAYBE;
+
+    std::vector<CodePoint_t> original;
+    std::vector<CodePoint_t> nfd;
+
+    for (const char *p = begin; p != end; ) {
+      CodePoint_t cp = nextCodePoint(p, end);
+      original.push_back(cp);
+      decompose(cp, t, nfd);
+    }
+
+    // Canonical ordering: stable sort each run of non-starters by class.
+    std::vector<unsigned> ccc(nfd.size());
+    for (size_t i = 0; i < nfd.size(); i++)
+      ccc[i] = combiningClass(nfd[i], t);
+
+    for (size_t i = 1; i < nfd.size(); i++) {
+      for (size_t j = i; j > 0 && ccc[j] != 0 && ccc[j - 1] > ccc[j]; j--) {
+        std::swap(nfd[j], nfd[j - 1]);
+        std::swap(ccc[j], ccc[j - 1]);
+      }
+    }
+
+    // Canonical composition.
+    std::vector<CodePoint_t> nfc;
+    size_t starter = 0;
+    bool haveStarter = false;
+    unsigned lastCcc = 0;
+
+    for (size_t i = 0; i < nfd.size(); i++) {
+      CodePoint_t cp = nfd[i];
+
+      if (haveStarter) {
+        bool adjacent = (nfc.size() == starter + 1);
+        if (adjacent || (lastCcc != 0 && lastCcc < ccc[i])) {
+          CodePoint_t composite = composePair(nfc[starter], cp, t);
+          if (composite != CODEPOINT_EOF) {
+            nfc[starter] = composite;
+            continue;
+          }
+        }
+      }
+
+      if (ccc[i] == 0) {
+        starter = nfc.size();
+        haveStarter = true;
+      }
+      nfc.push_back(cp);
+      lastCcc = ccc[i];
+    }
+
+    return (nfc == original) ? NFC_YES : NFC_NO;
+  }
+
+  static NfcQuickCheck
+  nfc_check(const char *s, size_t len, const NfcTables& t, size_t *offset,
+            bool resolve)
+  {
+    const char *p = s;
+    const char *bound = s + len;
+    const char *segment = s;   // last starter with NFC_QC=Yes
+    const char *maybeAt = 0;
+    unsigned lastCcc = 0;
+
+    while (p != bound) {
+      size_t ascii = utf8_ascii_span(p, bound - p);
+      if (ascii) {
+        p += ascii;
+        segment = p - 1;
+        lastCcc = 0;
+        if (p == bound)
+          break;
+      }
+
+      const char *at = p;
+      CodePoint_t cp = nextCodePoint(p, bound);
+
+      if (cp == CODEPOINT_EOF) {
+        if (offset)
+          *offset = at - s;
+        return NFC_NO;
+      }
+
+      if (cp < FIRST_COMBINING) {
+        segment = at;
+        lastCcc = 0;
+        continue;
+      }
+
+      unsigned ccc = t.combiningClass(cp);
+      NfcQuickCheck qc = t.quickCheck(cp);
+
+      if ((ccc != 0 && lastCcc > ccc) || qc == NFC_NO) {
+        if (offset)
+          *offset = segment - s;
+        return NFC_NO;
+      }
+
+      if (qc == NFC_MAYBE) {
+        if (!resolve) {
+          if (!maybeAt)
+            maybeAt = segment;
+        }
+        else {
+          // Extend the segment up to the next stable starter, and see
+          // whether normalizing it changes it.
+          const char *end = p;
+          while (end != bound) {
+            const char *q = end;
+            CodePoint_t next = nextCodePoint(q, bound);
+            if (next == CODEPOINT_EOF) {
+              if (offset)
+                *offset = end - s;
+              return NFC_NO;
+            }
+            if (isStableStarter(next, t))
+              break;
+            end = q;
+          }
+
+          NfcQuickCheck r = segmentIsNfc(segment, end, t);
+          if (r == NFC_NO) {
+            if (offset)
+              *offset = segment - s;
+            return NFC_NO;
+          }
+          if (r == NFC_MAYBE && !maybeAt)
+            maybeAt = segment;
+
+          p = end;
+          lastCcc = 0;
+          continue;
+        }
+      }
+
+      if (ccc == 0 && qc == NFC_YES)
+        segment = at;
+      lastCcc = ccc;
+    }
+
+    if (maybeAt) {
+      if (offset)
+        *offset = maybeAt - s;
+      return NFC_MAYBE;
+    }
+
+    return NFC_YES;
+  }
+
+  NfcQuickCheck
+  nfc_quick_check(const char *s, size_t len, const NfcTables& tables,
+                  size_t *offset)
+  {
+    return nfc_check(s, len, tables, offset, false);
+  }
+
+  NfcQuickCheck
+  nfc_validate(const char *s, size_t len, const NfcTables& tables,
+               size_t *offset)
+  {
+    return nfc_check(s, len, tables, offset, true);
+  }
+}
@@ -0,0 +1,114 @@
+#ifndef NFC_H
+#define NFC_H
+
+/**************************************************************************
+ *
+ * Copyright (C) 2016, Jonathan S. Shapiro
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ *   - Redistributions of source code must contain the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer.
+ *
+ *   - Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions, and the following
+ *     disclaimer in the documentation and/or other materials
+ *     provided with the distribution.
+ *
+ *   - Neither the names of the copyright holders nor the names of any
+ *     of any contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written
+ *     permission.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **************************************************************************/
+
+#include "CodePoint.h"
+
+namespace libucd {
+  /// @brief Values of the NFC_Quick_Check property, and results of the
+  /// NFC checks below.
+  enum NfcQuickCheck {
+    NFC_YES,
+    NFC_NO,
+    NFC_MAYBE
+  };
+
+  /// @brief Maximum length of a single-level canonical decomposition
+  /// mapping.
+  const size_t NFC_MAX_MAPPING = 4;
+
+  /// @brief The Unicode data used by the NFC checks.
+  ///
+  /// libucd carries no Unicode tables of its own, so these are supplied
+  /// by the client, normally as thin wrappers around the lookup
+  /// functions that gen-props emits, e.g.
+  ///
+  ///     gen-props table --name NFC_QC --select NFC_QC ... DerivedNormalizationProps.txt
+  ///     gen-props table --name CCC --numeric ... DerivedCombiningClass.txt
+  ///
+  /// quickCheck and combiningClass are required. decomposition and
+  /// compose are only consulted to resolve NFC_MAYBE results; if either
+  /// is NULL, nfc_validate() returns NFC_MAYBE where it would need them.
+  struct NfcTables {
+    /// @brief NFC_Quick_Check value of @p cp.
+    NfcQuickCheck (*quickCheck)(CodePoint_t cp);
+
+    /// @brief Canonical_Combining_Class value of @p cp.
+    unsigned (*combiningClass)(CodePoint_t cp);
+
+    /// @brief Store the single-level canonical decomposition mapping of
+    /// @p cp (at most NFC_MAX_MAPPING code points) in @p mapping and
+    /// return its length, or return 0 if @p cp has none. Hangul syllables
+    /// are decomposed algorithmically and need not be handled.
+    size_t (*decomposition)(CodePoint_t cp, CodePoint_t *mapping);
+
+    /// @brief Return the primary composite of @p first followed by
+    /// @p second, or CODEPOINT_EOF if there is none. Hangul syllables are
+    /// composed algorithmically and need not be handled.
+    CodePoint_t (*compose)(CodePoint_t first, CodePoint_t second);
+  };
+
+  /// @brief Apply the NFC_Quick_Check algorithm of UAX #15 to the @p len
+  /// bytes of UTF-8 at @p s.
+  ///
+  /// Runs of ASCII are skipped without being decoded, and code points
+  /// below U+0300 (none of which combine) are not looked up. Returns
+  /// NFC_NO for ill-formed UTF-8.
+  ///
+  /// Unless the result is NFC_YES, @p *offset (if @p offset is non-NULL)
+  /// is set to the byte offset of the normalization segment in which the
+  /// check stopped: the last starter with NFC_Quick_Check=Yes before the
+  /// offending code point, or the offending byte of ill-formed input.
+  NfcQuickCheck nfc_quick_check(const char *s, size_t len,
+                                const NfcTables& tables, size_t *offset = 0);
+
+  /// @brief Determine whether the @p len bytes of UTF-8 at @p s are in
+  /// NFC.
+  ///
+  /// This is nfc_quick_check(), except that each NFC_MAYBE is resolved by
+  /// normalizing the segment of text around it (from the preceding code
+  /// point that is a starter with NFC_Quick_Check=Yes up to the next one)
+  /// and comparing. Unless the result is NFC_YES, @p *offset is set to the
+  /// start of the first segment that is not in NFC.
+  NfcQuickCheck nfc_validate(const char *s, size_t len,
+                             const NfcTables& tables, size_t *offset = 0);
+}
+
+#endif // NFC_H
@@ -36,10 +36,44 @@
  *
  **************************************************************************/
 
+#include <algorithm>
 #include <assert.h>
+#include <string.h>
+
+#include "Utf8Dfa.h"
 #include "utf8.h"
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define UTF8_HAVE_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#define UTF8_HAVE_SSE2 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 namespace libucd {
+  // Index of the least significant set bit of a non-zero mask.
+  static inline unsigned
+  utf8_ctz(uint32_t mask)
+  {
+#if defined(_MSC_VER)
+    unsigned long ndx;
+    _BitScanForward(&ndx, mask);
+    return ndx;
+#else
+    return __builtin_ctz(mask);
+#endif
+  }
+
   CodePoint_t
   utf8_decode(const char *utf8String, const char **next, const char *bound)
   {
@@ -63,7 +97,7 @@ namespace libucd {
       if ((b & 0xc0) != 0x80)
         return CODEPOINT_EOF;
 
-      c |= (utf8String[1] & 0x3F);
+      c |= (b & 0x3F);
     }
 
     if (c > CODEPOINT_MAX)
@@ -75,8 +109,9 @@ namespace libucd {
     return c;
   }
 
-  void
-  utf8_encode(CodePoint_t cp, char *s, char **sEnd)
+  // Encode /cp/ at /s/ and return the byte following it.
+  static inline char *
+  utf8_encode_one(CodePoint_t cp, char *s)
   {
     assert ( cp <= CODEPOINT_MAX );
 
@@ -87,7 +122,7 @@ namespace libucd {
       *s++ = (0xc0 | (cp >> 6));
       *s++ = (0x80 | (cp & 0x3f));
     }
-    else if (cp <= 0x0FFF) {
+    else if (cp <= 0xffff) {
       *s++ = (0xE0 | (cp >> 12));
       *s++ = (0x80 | ((cp >> 6) & 0x3f));
       *s++ = (0x80 | (cp & 0x3f));
@@ -99,6 +134,13 @@ namespace libucd {
       *s++ = (0x80 | (cp & 0x3f));
     }
 
+    return s;
+  }
+
+  void
+  utf8_encode(CodePoint_t cp, char *s, char **sEnd)
+  {
+    s = utf8_encode_one(cp, s);
     if (sEnd)
       *sEnd = s;
   }
@@ -108,23 +150,423 @@ namespace libucd {
   {
     assert ( cp <= CODEPOINT_MAX );
 
-    char encoding[5];
-    char *sEnd;
+    char encoding[4];
+    char *sEnd = utf8_encode_one(cp, encoding);
 
-    utf8_encode(cp, encoding, &sEnd);
-    *sEnd = 0;
-    return encoding;
+    // Not NUL-terminated: U+0000 encodes as a single zero byte.
+    return std::string(encoding, sEnd - encoding);
   }
 
   size_t
-  utf8_cplen(const char *s, const char *bound)
+  utf8_encoded_length(const CodePoint_t *cps, size_t n)
   {
     size_t len = 0;
-    while (*s && (s != bound)) {
-      s += utf8_decode_length(*s);
-      len++;
+    size_t i = 0;
+
+#ifdef UTF8_HAVE_SSE2
+    // Each lane counts 1 + (cp > 0x7f) + (cp > 0x7ff) + (cp > 0xffff).
+    // Code points are at most CODEPOINT_MAX, so the signed compares are
+    // exact. The lane sums are flushed often enough not to overflow.
+    const __m128i lim1 = _mm_set1_epi32(0x7f);
+    const __m128i lim2 = _mm_set1_epi32(0x7ff);
+    const __m128i lim3 = _mm_set1_epi32(0xffff);
+    while (i + 4 <= n) {
+      size_t blockEnd = std::min(n & ~size_t(3), i + (size_t(1) << 24));
+      __m128i sum = _mm_setzero_si128();
+      for (; i < blockEnd; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (cps + i));
+        sum = _mm_sub_epi32(sum, _mm_cmpgt_epi32(v, lim1));
+        sum = _mm_sub_epi32(sum, _mm_cmpgt_epi32(v, lim2));
+        sum = _mm_sub_epi32(sum, _mm_cmpgt_epi32(v, lim3));
+      }
+
+      uint32_t lanes[4];
+      _mm_storeu_si128((__m128i *) lanes, sum);
+      len += size_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
     }
+    len += i;
+#endif
+
+    for (; i < n; i++)
+      len += utf8_encoded_length(cps[i]);
 
     return len;
   }
+
+  size_t
+  utf8_encode_all(const CodePoint_t *cps, size_t n, char *out)
+  {
+    char *o = out;
+    size_t i = 0;
+
+#ifdef UTF8_HAVE_SSE2
+    // ASCII fast path: narrow 16 code points at a time with saturating
+    // packs, so that anything above 0x7f leaves its byte's top bit set.
+    // Each remaining code point takes at least one byte, so the 16-byte
+    // store never runs past the end of a correctly sized buffer, even
+    // when only a prefix of it is kept.
+    while (i + 16 <= n) {
+      __m128i a = _mm_loadu_si128((const __m128i *) (cps + i));
+      __m128i b = _mm_loadu_si128((const __m128i *) (cps + i + 4));
+      __m128i c = _mm_loadu_si128((const __m128i *) (cps + i + 8));
+      __m128i d = _mm_loadu_si128((const __m128i *) (cps + i + 12));
+      __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(a, b),
+                                       _mm_packs_epi32(c, d));
+      _mm_storeu_si128((__m128i *) o, bytes);
+
+      uint32_t m = (uint32_t) _mm_movemask_epi8(bytes);
+      if (!m) {
+        i += 16;
+        o += 16;
+        continue;
+      }
+
+      // Keep the ASCII prefix and encode the rest of the block one code
+      // point at a time.
+      size_t blockEnd = i + 16;
+      unsigned ascii = utf8_ctz(m);
+      i += ascii;
+      o += ascii;
+      for (; i < blockEnd; i++)
+        o = utf8_encode_one(cps[i], o);
+    }
+#endif
+
+    for (; i < n; i++)
+      o = utf8_encode_one(cps[i], o);
+
+    return o - out;
+  }
+
+  std::string
+  utf8_encode_all(const CodePoint_t *cps, size_t n)
+  {
+    std::string s(utf8_encoded_length(cps, n), '\0');
+    if (!s.empty())
+      utf8_encode_all(cps, n, &s[0]);
+    return s;
+  }
+
+  size_t
+  utf8_cpcount(const char *s, size_t len)
+  {
+    size_t count = 0;
+    size_t i = 0;
+
+    // A byte starts a code point unless it is a continuation byte, which
+    // as a signed char is below -64. Per-byte counts are accumulated with
+    // subtraction of the compare mask for at most 255 steps, then summed
+    // with psadbw.
+#ifdef UTF8_HAVE_AVX2
+    const __m256i cont32 = _mm256_set1_epi8(-65);
+    while (i + 32 <= len) {
+      __m256i acc = _mm256_setzero_si256();
+      for (int k = 0; k < 255 && i + 32 <= len; k++, i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *) (s + i));
+        acc = _mm256_sub_epi8(acc, _mm256_cmpgt_epi8(v, cont32));
+      }
+
+      __m256i sad = _mm256_sad_epu8(acc, _mm256_setzero_si256());
+      __m128i sums = _mm_add_epi64(_mm256_castsi256_si128(sad),
+                                   _mm256_extracti128_si256(sad, 1));
+      count += _mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+    }
+#endif
+#ifdef UTF8_HAVE_SSE2
+    const __m128i cont16 = _mm_set1_epi8(-65);
+    while (i + 16 <= len) {
+      __m128i acc = _mm_setzero_si128();
+      for (int k = 0; k < 255 && i + 16 <= len; k++, i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (s + i));
+        acc = _mm_sub_epi8(acc, _mm_cmpgt_epi8(v, cont16));
+      }
+
+      __m128i sums = _mm_sad_epu8(acc, _mm_setzero_si128());
+      count += _mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+    }
+#endif
+
+    for (; i < len; i++)
+      count += (((unsigned char) s[i] & 0xc0U) != 0x80U);
+
+    return count;
+  }
+
+  size_t
+  utf8_cplen(const char *s, const char *bound)
+  {
+    // The string ends at the first NUL or at /bound/, whichever is first.
+    size_t len;
+    if (bound) {
+      const void *nul = memchr(s, 0, bound - s);
+      len = (nul ? (const char *) nul : bound) - s;
+    }
+    else {
+      len = strlen(s);
+    }
+
+    return utf8_cpcount(s, len);
+  }
+
+  size_t
+  utf8_ascii_span(const char *s, size_t len)
+  {
+    size_t i = 0;
+
+#ifdef UTF8_HAVE_AVX2
+    for (; i + 32 <= len; i += 32) {
+      __m256i v = _mm256_loadu_si256((const __m256i *) (s + i));
+      uint32_t m = (uint32_t) _mm256_movemask_epi8(v);
+      if (m)
+        return i + utf8_ctz(m);
+    }
+#endif
+#ifdef UTF8_HAVE_SSE2
+    for (; i + 16 <= len; i += 16) {
+      __m128i v = _mm_loadu_si128((const __m128i *) (s + i));
+      uint32_t m = (uint32_t) _mm_movemask_epi8(v);
+      if (m)
+        return i + utf8_ctz(m);
+    }
+#endif
+
+    for (; i < len; i++) {
+      if ((unsigned char) s[i] & 0x80U)
+        break;
+    }
+
+    return i;
+  }
+
+  size_t
+  utf8_validate(const char *buf, size_t len)
+  {
+    const char *s = buf;
+    const char *bound = buf + len;
+
+    while (s != bound) {
+      s += utf8_ascii_span(s, bound - s);
+      if (s == bound)
+        break;
+
+      // Non-ASCII sequences go through the scalar decoder, so that the
+      // accept/reject decision is the same one utf8_decode() makes.
+      const char *next;
+      if (utf8_decode(s, &next, bound) == CODEPOINT_EOF)
+        break;
+      s = next;
+    }
+
+    return s - buf;
+  }
+
+  // Widen the ASCII bytes at the start of the /len/ bytes at /s/ into
+  // /out/, a whole vector at a time, stopping at the first vector that
+  // holds a non-ASCII byte. Returns the number of bytes widened, which
+  // may be less than the length of the ASCII prefix.
+  static inline size_t
+  utf8_widen_ascii(const char *s, size_t len, CodePoint_t *out)
+  {
+    size_t i = 0;
+
+#ifdef UTF8_HAVE_AVX2
+    for (; i + 32 <= len; i += 32) {
+      __m256i v = _mm256_loadu_si256((const __m256i *) (s + i));
+      if (_mm256_movemask_epi8(v))
+        break;
+
+      for (int k = 0; k < 32; k += 8) {
+        __m128i b8 = _mm_loadl_epi64((const __m128i *) (s + i + k));
+        _mm256_storeu_si256((__m256i *) (out + i + k),
+                            _mm256_cvtepu8_epi32(b8));
+      }
+    }
+#endif
+#ifdef UTF8_HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= len; i += 16) {
+      __m128i v = _mm_loadu_si128((const __m128i *) (s + i));
+      if (_mm_movemask_epi8(v))
+        return i;
+
+      __m128i lo = _mm_unpacklo_epi8(v, zero);
+      __m128i hi = _mm_unpackhi_epi8(v, zero);
+      _mm_storeu_si128((__m128i *) (out + i + 0), _mm_unpacklo_epi16(lo, zero));
+      _mm_storeu_si128((__m128i *) (out + i + 4), _mm_unpackhi_epi16(lo, zero));
+      _mm_storeu_si128((__m128i *) (out + i + 8), _mm_unpacklo_epi16(hi, zero));
+      _mm_storeu_si128((__m128i *) (out + i + 12), _mm_unpackhi_epi16(hi, zero));
+    }
+#endif
+
+    (void) s;
+    (void) out;
+    return i;
+  }
+
+  size_t
+  utf8_decode_all(const char *buf, size_t len, CodePoint_t *out,
+                  const char **next)
+  {
+    const char *s = buf;
+    const char *bound = buf + len;
+    CodePoint_t *o = out;
+
+    while (s != bound) {
+      // ASCII fast path: widen whole vectors straight into /out/.
+      size_t n = utf8_widen_ascii(s, bound - s, o);
+      s += n;
+      o += n;
+      if (s == bound)
+        break;
+
+      unsigned char b0 = *s;
+      if (b0 < 0x80U) {
+        *o++ = b0;
+        s++;
+        continue;
+      }
+
+      const char *nx;
+      CodePoint_t c = utf8_decode(s, &nx, bound);
+      if (c == CODEPOINT_EOF)
+        break;
+
+      *o++ = c;
+      s = nx;
+    }
+
+    if (next)
+      *next = s;
+
+    return o - out;
+  }
+
+  const char *
+  utf8_error_name(Utf8Error error)
+  {
+    switch (error) {
+    case UTF8_OK:
+      return "no error";
+    case UTF8_INVALID_BYTE:
+      return "invalid byte";
+    case UTF8_UNEXPECTED_CONTINUATION:
+      return "unexpected continuation byte";
+    case UTF8_INCOMPLETE:
+      return "incomplete sequence";
+    case UTF8_TRUNCATED:
+      return "truncated sequence";
+    case UTF8_OVERLONG:
+      return "overlong encoding";
+    case UTF8_SURROGATE:
+      return "encoded surrogate";
+    case UTF8_TOO_LARGE:
+      return "code point above U+10FFFF";
+    }
+    return "unknown error";
+  }
+
+  // The start of the sequence whose bytes, all accepted by the DFA, end
+  // just before /s/. They are a lead byte and up to two continuation
+  // bytes, none of them before /buf/.
+  static inline const char *
+  utf8_sequence_start(const char *buf, const char *s)
+  {
+    do
+      s--;
+    while (s != buf && ((unsigned char) *s & 0xc0U) == 0x80U);
+    return s;
+  }
+
+  size_t
+  utf8_decode_checked(const char *buf, size_t len, CodePoint_t *out,
+                      Utf8ErrorMode mode, Utf8DecodeStatus *status,
+                      const char **next)
+  {
+    const unsigned char *s = (const unsigned char *) buf;
+    const unsigned char *bound = s + len;
+    CodePoint_t *o = out;
+
+    Utf8DecodeStatus st = { UTF8_OK, 0, 0 };
+    uint32_t state = UTF8_DFA_ACCEPT;
+    CodePoint_t cp = 0;
+    bool stopped = false;
+
+    while (s != bound && !stopped) {
+      if (state == UTF8_DFA_ACCEPT) {
+        size_t n = utf8_widen_ascii((const char *) s, bound - s, o);
+        s += n;
+        o += n;
+        // The bulk path stops at the first chunk that is not all ASCII;
+        // the ASCII bytes at its start are copied one at a time.
+        while (s != bound && *s < 0x80)
+          *o++ = *s++;
+        if (s == bound)
+          break;
+      }
+
+      // Run the DFA over at most a block before looking for ASCII
+      // again, leaving early when a sequence is complete and the next
+      // byte is ASCII, so that text mixing ASCII with other scripts
+      // returns to the bulk path at once. The current code point is
+      // stored whether or not it is complete, and the output only
+      // advances once it is, so the width of a sequence costs no
+      // branch. /o/ is always behind the input, so the store stays
+      // within /out/.
+      const unsigned char *blockEnd = s + std::min<size_t>(bound - s, 16);
+      while (s != blockEnd) {
+        uint32_t prev = state;
+        state = utf8_dfa_step(state, cp, *s);
+        *o = cp;
+        o += (state == UTF8_DFA_ACCEPT);
+
+        if (state == UTF8_DFA_REJECT) {
+          // An ill-formed sequence ends at the byte that was refused.
+          // That byte is part of it only if it was meant to start it.
+          const char *start = (prev == UTF8_DFA_ACCEPT)
+            ? (const char *) s : utf8_sequence_start(buf, (const char *) s);
+          if (st.numErrors++ == 0) {
+            st.error = utf8_dfa_error(prev, *s);
+            st.errorOffset = start - buf;
+          }
+
+          state = UTF8_DFA_ACCEPT;
+          if (mode == UTF8_STOP) {
+            s = (const unsigned char *) start;
+            stopped = true;
+            break;
+          }
+
+          *o++ = UTF8_REPLACEMENT_CHARACTER;
+          if (prev == UTF8_DFA_ACCEPT)
+            s++;
+          break;
+        }
+
+        s++;
+        if (state == UTF8_DFA_ACCEPT && s != blockEnd && *s < 0x80)
+          break;
+      }
+    }
+
+    if (state != UTF8_DFA_ACCEPT) {
+      // The input ended inside a sequence.
+      const char *start = utf8_sequence_start(buf, (const char *) s);
+      if (st.numErrors++ == 0) {
+        st.error = UTF8_TRUNCATED;
+        st.errorOffset = start - buf;
+      }
+
+      if (mode == UTF8_STOP)
+        s = (const unsigned char *) start;
+      else
+        *o++ = UTF8_REPLACEMENT_CHARACTER;
+    }
+
+    if (status)
+      *status = st;
+    if (next)
+      *next = (const char *) s;
+
+    return o - out;
+  }
 }
@@ -105,8 +105,107 @@ namespace libucd {
   /// if @p sEnd is non-NULL.
   void utf8_encode(CodePoint_t cp, char *s, char **sEnd);
 
-  /// @brief Compute the length of a [sub]string in code points
+  /// @brief Return the total length of the UTF-8 encodings of the @p n
+  /// code points at @p cps, each of which must be at most CODEPOINT_MAX.
+  size_t utf8_encoded_length(const CodePoint_t *cps, size_t n);
+
+  /// @brief Encode the @p n code points at @p cps to UTF-8 at @p out,
+  /// returning the number of bytes written.
+  ///
+  /// @p out must have room for utf8_encoded_length(@p cps, @p n) bytes;
+  /// 4 * @p n bytes is always enough.
+  size_t utf8_encode_all(const CodePoint_t *cps, size_t n, char *out);
+
+  /// @brief Return the UTF-8 encoding of the @p n code points at @p cps.
+  std::string utf8_encode_all(const CodePoint_t *cps, size_t n);
+
+  /// @brief Compute the length of a [sub]string in code points.
+  ///
+  /// The string ends at its first NUL or at @p bound, whichever comes
+  /// first. Every byte that is not a UTF-8 continuation byte counts as
+  /// the start of a code point, which is exact for well-formed input.
   size_t utf8_cplen(const char *s, const char *bound = 0);
+
+  /// @brief Count the code points in the @p len bytes at @p s, which may
+  /// include NULs, as utf8_cplen() does: by counting the bytes that are
+  /// not continuation bytes.
+  size_t utf8_cpcount(const char *s, size_t len);
+
+  /// @brief Return the length of the longest prefix of the @p len bytes
+  /// at @p s that consists entirely of ASCII (7-bit) bytes.
+  size_t utf8_ascii_span(const char *s, size_t len);
+
+  /// @brief Validate the @p len bytes at @p buf as a sequence of UTF-8
+  /// encoded code points.
+  ///
+  /// Returns the length in bytes of the longest prefix of @p buf that
+  /// decodes successfully, so the input is valid exactly if the result
+  /// is @p len. The accept/reject decision for each sequence is the one
+  /// made by utf8_decode(), so the offset returned here is the offset at
+  /// which a utf8_decode() loop over the same buffer would stop.
+  size_t utf8_validate(const char *buf, size_t len);
+
+  /// @brief Decode the @p len bytes at @p buf into @p out, which must have
+  /// room for @p len code points.
+  ///
+  /// Returns the number of code points written. Decoding stops at the
+  /// first sequence that utf8_decode() would reject; if @p next is
+  /// non-NULL, @p *next is set to the first byte that was not consumed
+  /// (@p buf + @p len on success).
+  size_t utf8_decode_all(const char *buf, size_t len, CodePoint_t *out,
+                         const char **next = 0);
+
+  /// @brief The ways in which a UTF-8 sequence can be ill-formed.
+  enum Utf8Error {
+    UTF8_OK,
+    UTF8_INVALID_BYTE,              // F8..FF, which never appear
+    UTF8_UNEXPECTED_CONTINUATION,   // 80..BF where a sequence should start
+    UTF8_INCOMPLETE,                // sequence cut short by another byte
+    UTF8_TRUNCATED,                 // sequence cut short by end of input
+    UTF8_OVERLONG,                  // C0, C1, E0 80..9F or F0 80..8F
+    UTF8_SURROGATE,                 // ED A0..BF
+    UTF8_TOO_LARGE                  // F4 90..BF or F5..F7
+  };
+
+  /// @brief Return a short English description of @p error.
+  const char *utf8_error_name(Utf8Error error);
+
+  /// @brief What a checked decoder does at an ill-formed sequence.
+  enum Utf8ErrorMode {
+    UTF8_STOP,      // stop before it
+    UTF8_REPLACE    // emit U+FFFD for it and carry on
+  };
+
+  /// @brief The code point substituted for ill-formed sequences.
+  static const CodePoint_t UTF8_REPLACEMENT_CHARACTER = 0xfffd;
+
+  /// @brief Errors seen by utf8_decode_checked().
+  struct Utf8DecodeStatus {
+    Utf8Error error;        // the first error, or UTF8_OK
+    size_t errorOffset;     // byte offset of the first ill-formed sequence
+    size_t numErrors;       // number of ill-formed sequences
+  };
+
+  /// @brief Decode the @p len bytes at @p buf into @p out, which must have
+  /// room for @p len code points, accepting only well-formed UTF-8.
+  ///
+  /// Unlike utf8_decode(), this rejects overlong forms and surrogates,
+  /// and says why a sequence was rejected. Decoding uses a table-driven
+  /// DFA (after Bjoern Hoehrmann's), so that apart from ASCII runs,
+  /// which are widened in bulk, each byte costs the same two table
+  /// lookups whatever the width of the sequence it belongs to.
+  ///
+  /// Returns the number of code points written. In UTF8_STOP mode
+  /// decoding stops at the first ill-formed sequence, and if @p next is
+  /// non-NULL, @p *next is set to its first byte (@p buf + @p len on
+  /// success). In UTF8_REPLACE mode each maximal ill-formed subpart is
+  /// replaced by one U+FFFD, as Unicode recommends (section 3.9), and
+  /// the whole buffer is always consumed. If @p status is non-NULL it
+  /// receives the first error, its offset and the number of errors.
+  size_t utf8_decode_checked(const char *buf, size_t len, CodePoint_t *out,
+                             Utf8ErrorMode mode = UTF8_STOP,
+                             Utf8DecodeStatus *status = 0,
+                             const char **next = 0);
 }
 
 #endif // UTF8_H
@@ -7,3 +7,11 @@ SUBDIRS += \
     compile-props \
     gen-props \
     lang/c++/libucd
+
+compile-props.depends = lang/c++/libucd
+gen-props.depends = lang/c++/libucd
+
+bench {
+    SUBDIRS += lang/c++/libucd/bench
+    lang/c++/libucd/bench.depends = lang/c++/libucd
+}